@@ -0,0 +1,101 @@
+#include "Guijo/Objects/EventReceiver.hpp"
+#include "Guijo/Event/BasicEvents.hpp"
+
+using namespace Guijo;
+
+// Sends events to receivers that handle all 13 basic events, like widgets
+// that respond to everything. Compares handlers stored per event type with
+// a list of handlers that each cast the receiver and the event, like events
+// were dispatched before. Prints the time to send one event to all of them.
+
+struct Widget : EventReceiver {
+    std::size_t handled = 0;
+
+    Widget() { event<Widget>(); }
+
+    void mousePress(const MousePress&) { ++handled; }
+    void mouseMove(const MouseMove&) { ++handled; }
+    void mouseDrag(const MouseDrag&) { ++handled; }
+    void mouseClick(const MouseClick&) { ++handled; }
+    void mouseRelease(const MouseRelease&) { ++handled; }
+    void mouseWheel(const MouseWheel&) { ++handled; }
+    void mouseEnter(const MouseEnter&) { ++handled; }
+    void mouseExit(const MouseExit&) { ++handled; }
+    void focus(const Focus&) { ++handled; }
+    void unfocus(const Unfocus&) { ++handled; }
+    void keyPress(const KeyPress&) { ++handled; }
+    void keyType(const KeyType&) { ++handled; }
+    void keyRelease(const KeyRelease&) { ++handled; }
+};
+
+struct CastHandler {
+    virtual ~CastHandler() = default;
+    virtual void handle(EventReceiver&, const Event&) const = 0;
+};
+
+template<auto Fun> struct TypedCastHandler : CastHandler {
+    void handle(EventReceiver& self, const Event& e) const override {
+        using self_type = detail::member_function_type_t<decltype(Fun)>;
+        using args = detail::function_args_t<detail::signature_t<decltype(Fun)>>;
+        using event_type = std::decay_t<std::tuple_element_t<0, args>>;
+        if (auto _self = dynamic_cast<self_type*>(&self))
+            if (auto _e = dynamic_cast<const event_type*>(&e)) (_self->*Fun)(*_e);
+    }
+};
+
+std::vector<std::unique_ptr<CastHandler>> castHandlers() {
+    std::vector<std::unique_ptr<CastHandler>> _handlers;
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mousePress>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseMove>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseDrag>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseClick>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseRelease>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseWheel>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseEnter>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::mouseExit>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::focus>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::unfocus>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::keyPress>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::keyType>{});
+    _handlers.emplace_back(new TypedCastHandler<&Widget::keyRelease>{});
+    return _handlers;
+}
+
+template<class Fun>
+double measure(std::size_t runs, Fun&& fun) {
+    using namespace std::chrono;
+    auto _start = steady_clock::now();
+    for (std::size_t _i = 0; _i < runs; ++_i) fun();
+    return duration<double, std::micro>(steady_clock::now() - _start).count() / runs;
+}
+
+int main() {
+    constexpr std::size_t _count = 5000;
+    constexpr std::size_t _runs = 200;
+    std::vector<std::unique_ptr<Widget>> _widgets;
+    std::vector<std::vector<std::unique_ptr<CastHandler>>> _castHandlers;
+    for (std::size_t _i = 0; _i < _count; ++_i) {
+        _widgets.emplace_back(new Widget{});
+        _castHandlers.push_back(castHandlers());
+    }
+
+    const auto _scenario = [&](std::string_view name, const Event& e) {
+        const double _typed = measure(_runs, [&] {
+            for (auto& _widget : _widgets) _widget->handle(e);
+        });
+        const double _cast = measure(_runs, [&] {
+            for (std::size_t _i = 0; _i < _count; ++_i)
+                for (auto& _handler : _castHandlers[_i]) _handler->handle(*_widgets[_i], e);
+        });
+        std::cout << name << ", " << _count << " receivers\n  by type: " << _typed
+            << " us\n  casting: " << _cast << " us (" << _cast / _typed << "x)\n";
+    };
+
+    _scenario("mouse move", MouseMove{ { 10, 10 } });
+    _scenario("mouse press", MousePress{ { 10, 10 }, MouseButton::Left, 0 });
+    _scenario("key type", KeyType{ 'a', 0, false });
+
+    std::size_t _handled = 0;
+    for (auto& _widget : _widgets) _handled += _widget->handled;
+    if (_handled != 2 * 3 * _runs * _count) std::cout << "handlers missed events\n";
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "Guijo/Objects/Object.hpp"
+#include <cstdlib>
+#include <new>
+
+using namespace Guijo;
+
+// Lays out synthetic object trees without a window or graphics context.
+// Every scenario is measured as a full layout of the whole tree and as an
+// incremental layout after a single change, reporting the time per pass,
+// boxes laid out per second and heap allocations per pass. Afterwards the
+// incremental result is compared with a full layout of the same tree.
+
+std::atomic<std::size_t> allocations = 0; // Heap allocations since start
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* _ptr = std::malloc(size ? size : 1)) return _ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+struct Scenario {
+    std::string_view name;
+    std::function<void(Object&)> build;              // Add children to the root
+    std::function<void(Object&, std::size_t)> change; // Change one thing, with the pass index
+};
+
+void invalidateAll(Object& object) {
+    object.box.invalidate();
+    for (auto& _child : object.objects()) invalidateAll(*_child);
+}
+
+std::size_t count(Object& object) {
+    std::size_t _count = 1;
+    for (auto& _child : object.objects()) _count += count(*_child);
+    return _count;
+}
+
+Object& nth(Object& object, std::size_t index) { return *object.objects()[index]; }
+
+void collect(Object& object, std::vector<Dimensions<float>>& out) {
+    out.push_back(object.dimensions());
+    for (auto& _child : object.objects()) collect(*_child, out);
+}
+
+// Whether a full layout places every box where the cached layout did
+bool matchesFullLayout(Object& root) {
+    std::vector<Dimensions<float>> _cached, _full;
+    collect(root, _cached);
+    invalidateAll(root);
+    root.box.format(root);
+    collect(root, _full);
+    return _cached == _full;
+}
+
+// Average time and allocations of a pass over a few runs
+void measure(std::string_view name, Object& root, std::size_t runs, auto&& prepare) {
+    using namespace std::chrono;
+    const std::size_t _boxes = count(root);
+    double _micros = 0;
+    std::size_t _allocations = 0;
+    Flex::Box::statistics.reset();
+    for (std::size_t _i = 0; _i < runs; ++_i) {
+        prepare(_i);
+        const std::size_t _before = allocations.load();
+        auto _start = steady_clock::now();
+        root.box.format(root);
+        _micros += duration<double, std::micro>(steady_clock::now() - _start).count();
+        _allocations += allocations.load() - _before;
+    }
+
+    std::cout << "  " << name << ": " << _micros / runs << " us, "
+        << static_cast<std::size_t>(_boxes * runs / (_micros / 1e6)) << " boxes/s, "
+        << _allocations / runs << " allocations, "
+        << Flex::Box::statistics.layouts / runs << " layouts\n";
+}
+
+int main() {
+    Flex::Box::windowSize = { 1920, 1080 };
+
+    const std::vector<Scenario> _scenarios{ {
+        "deep chain", [](Object& root) {
+            Object* _parent = &root;
+            for (std::size_t _i = 0; _i < 500; ++_i) {
+                auto _child = _parent->emplace<Object>();
+                _child->box.flex.direction = _i % 2 ? Flex::Row : Flex::Column;
+                _child->box.flex.grow = 1;
+                _child->box.padding = 1;
+                _parent = &*_child;
+            }
+        }, [](Object& root, std::size_t i) {
+            Object* _leaf = &root;
+            while (!_leaf->objects().empty()) _leaf = &nth(*_leaf, 0);
+            _leaf->box.size.height = i % 2 ? 10.f : 20.f;
+        },
+    }, {
+        "wide row", [](Object& root) {
+            for (std::size_t _i = 0; _i < 10000; ++_i) {
+                auto _child = root.emplace<Object>();
+                _child->box.size.width = 10.f;
+                _child->box.flex.grow = 1;
+            }
+        }, [](Object& root, std::size_t i) {
+            nth(root, 5000).box.flex.grow = i % 2 ? 1.f : 2.f;
+        },
+    }, {
+        "wrapped grid", [](Object& root) {
+            root.box.flex.wrap = Flex::DoWrap;
+            root.box.align.content = Flex::Start;
+            for (std::size_t _i = 0; _i < 10000; ++_i) {
+                auto _child = root.emplace<Object>();
+                _child->box.size = Vec2<float>{ 50, 50 };
+                _child->box.margin = 2;
+            }
+        }, [](Object& root, std::size_t i) {
+            nth(root, 0).box.size.width = i % 2 ? 50.f : 100.f;
+        },
+    }, {
+        "relative units", [](Object& root) {
+            for (std::size_t _i = 0; _i < 20; ++_i) {
+                auto _column = root.emplace<Object>();
+                _column->box.flex.direction = Flex::Column;
+                _column->box.size.width = Flex::pc{ 5 };
+                for (std::size_t _j = 0; _j < 100; ++_j) {
+                    auto _child = _column->emplace<Object>();
+                    _child->box.size.width = Flex::pc{ 50 };
+                    _child->box.size.height = Flex::vh{ 1 };
+                    _child->box.margin.left = Flex::vw{ .1f };
+                    _child->box.padding.top = Flex::pc{ 2 };
+                }
+            }
+        }, [](Object& root, std::size_t i) { // Resizing the root affects every percentage
+            root.box.size.width = i % 2 ? 1920.f : 1900.f;
+        },
+    }, {
+        "view units", [](Object& root) {
+            root.box.flex.wrap = Flex::DoWrap;
+            for (std::size_t _i = 0; _i < 100; ++_i) {
+                auto _child = root.emplace<Object>();
+                _child->box.size = Vec2<float>{ 100, 100 };
+                for (std::size_t _j = 0; _j < 10; ++_j) {
+                    auto _item = _child->emplace<Object>();
+                    _item->box.size.width = Flex::vw{ .5f };
+                }
+            }
+        }, [](Object&, std::size_t i) { // Back and forth, so earlier passes match again
+            Flex::Box::windowSize = { i % 2 ? 1920.f : 1900.f, 1080 };
+        },
+    }, {
+        "min/max clamping", [](Object& root) {
+            for (std::size_t _i = 0; _i < 5000; ++_i) {
+                auto _child = root.emplace<Object>();
+                _child->box.flex.basis = static_cast<float>(_i % 50);
+                _child->box.flex.grow = static_cast<float>(_i % 3);
+                _child->box.min.width = 5.f;
+                _child->box.max.width = 40.f;
+            }
+        }, [](Object& root, std::size_t i) {
+            nth(root, 2500).box.min.width = i % 2 ? 5.f : 15.f;
+        },
+    }, {
+        "animated values", [](Object& root) {
+            for (std::size_t _i = 0; _i < 2000; ++_i) {
+                auto _child = root.emplace<Object>();
+                _child->box.size.transition(1000);
+                _child->box.size = Vec2<float>{ 0, 10 };
+            }
+            for (auto& _child : root.objects()) _child->box.size.width = 1.f;
+        }, [](Object&, std::size_t) { // Next frame of the running transitions
+            FrameClock::set(FrameClock::now() + std::chrono::milliseconds(16));
+        },
+    } };
+
+    FrameClock::tick();
+    for (auto& _scenario : _scenarios) {
+        Object _root;
+        _root.dimensions({ 0, 0, 1920, 1080 });
+        _root.box.size = Vec2<float>{ 1920, 1080 };
+        _scenario.build(_root);
+        std::cout << _scenario.name << ", " << count(_root) << " boxes\n";
+
+        measure("full", _root, 10, [&](std::size_t) { invalidateAll(_root); });
+        measure("incremental", _root, 50, [&](std::size_t i) { _scenario.change(_root, i); });
+        if (!matchesFullLayout(_root)) std::cout << "  incremental layout differs from a full layout\n";
+        Flex::Box::windowSize = { 1920, 1080 };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "Guijo/Objects/Object.hpp"
+
+using namespace Guijo;
+
+// Lays out nested flex containers, every container has 2 children that
+// grow and stretch, alternating between rows and columns. Without the
+// layout cache every level formats its children 3 times, so the amount
+// of layout passes grows exponentially with the depth.
+
+void build(Object& parent, std::size_t depth) {
+    if (depth == 0) return;
+    for (std::size_t _i = 0; _i < 2; ++_i) {
+        auto _child = parent.emplace<Object>();
+        _child->box.flex.direction = depth % 2 ? Flex::Row : Flex::Column;
+        _child->box.flex.grow = 1;
+        _child->box.margin = 1;
+        build(*_child, depth - 1);
+    }
+}
+
+void invalidateAll(Object& object) {
+    object.box.invalidate();
+    for (auto& _child : object.objects()) invalidateAll(*_child);
+}
+
+std::size_t count(Object& object) {
+    std::size_t _count = 1;
+    for (auto& _child : object.objects()) _count += count(*_child);
+    return _count;
+}
+
+// Time a single layout of the entire tree, returns microseconds
+double measure(Object& root, bool invalidate) {
+    using namespace std::chrono;
+    if (invalidate) invalidateAll(root);
+    Flex::Box::statistics.reset();
+    auto _start = steady_clock::now();
+    root.box.format(root);
+    return duration<double, std::micro>(steady_clock::now() - _start).count();
+}
+
+int main() {
+    Flex::Box::windowSize = { 1920, 1080 };
+
+    const auto _report = [](std::string_view name, double micros) {
+        std::cout << "  " << name << ": " << micros << " us, "
+            << Flex::Box::statistics.layouts << " layouts, "
+            << Flex::Box::statistics.hits << " cache hits\n";
+    };
+
+    for (std::size_t _depth : { 4ull, 6ull, 8ull, 12ull }) {
+        Object _root;
+        _root.dimensions({ 0, 0, 1920, 1080 });
+        _root.box.size = Vec2<float>{ 1920, 1080 };
+        build(_root, _depth);
+        std::cout << _depth << " levels, " << count(_root) << " boxes\n";
+
+        // Without the cache only shallow trees finish in reasonable time
+        if (_depth <= 6) {
+            Flex::Box::cache = false;
+            _report("uncached", measure(_root, true));
+            Flex::Box::cache = true;
+        }
+
+        _report("cached, cold", measure(_root, true));
+        measure(_root, false); // Settle sizes assigned in the last pass
+        _report("cached, unchanged", measure(_root, false));
+
+        Flex::Box::parallel = true;
+        _report("parallel, cold", measure(_root, true));
+        Flex::Box::parallel = false;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "Guijo/Objects/Object.hpp"
+
+using namespace Guijo;
+
+// Resolves the flexible lengths of a single line of 10k items, with min
+// and max constraints spread out so most items get clamped, and some of
+// them conflict (min above max). Measured as a full layout, and as an
+// incremental layout after changing the min of an item that's clamped at
+// its max. That doesn't change the line's result, so the other items come
+// from the layout cache and resolving the line is most of the work. Any
+// change that moves the free space resizes all unclamped items, which is
+// then as much work as a full layout.
+
+constexpr std::size_t items = 10000;
+
+struct Scenario {
+    std::string_view name;
+    float basis; // Flex basis of item i is basis * (i % 100)
+    float width; // Width of the line
+};
+
+void build(Object& root, const Scenario& scenario) {
+    for (std::size_t _i = 0; _i < items; ++_i) {
+        auto _child = root.emplace<Object>();
+        _child->box.flex.basis = scenario.basis * static_cast<float>(_i % 100);
+        _child->box.flex.grow = static_cast<float>(1 + _i % 3);
+        _child->box.flex.shrink = static_cast<float>(1 + _i % 5);
+        _child->box.min.width = static_cast<float>(_i % 17 * 7);
+        _child->box.max.width = static_cast<float>(20 + _i % 13 * 11);
+        if (_i % 4 == 0) _child->box.margin.left = 1;
+    }
+}
+
+void invalidateAll(Object& object) {
+    object.box.invalidate();
+    for (auto& _child : object.objects()) invalidateAll(*_child);
+}
+
+// Average time of a pass over a few runs
+void measure(std::string_view name, Object& root, std::size_t runs, auto&& prepare) {
+    using namespace std::chrono;
+    double _micros = 0;
+    Flex::Box::statistics.reset();
+    for (std::size_t _i = 0; _i < runs; ++_i) {
+        prepare(_i);
+        auto _start = steady_clock::now();
+        root.box.format(root);
+        _micros += duration<double, std::micro>(steady_clock::now() - _start).count();
+    }
+
+    std::cout << "  " << name << ": " << _micros / runs << " us, "
+        << Flex::Box::statistics.layouts / runs << " layouts\n";
+}
+
+int main() {
+    const std::vector<Scenario> _scenarios{
+        { "growing", 0.f, 7e5f },
+        { "shrinking", 20.f, 7e5f },
+        { "mixed", 14.f, 7e5f },
+    };
+
+    for (auto& _scenario : _scenarios) {
+        Flex::Box::windowSize = { _scenario.width, 100 };
+        Object _root;
+        _root.dimensions({ 0, 0, _scenario.width, 100 });
+        _root.box.size = Vec2<float>{ _scenario.width, 100 };
+        build(_root, _scenario);
+        _root.box.format(_root);
+
+        // Items ending up at their min or max, and one clamped at its max to edit
+        std::size_t _clamped = 0;
+        Object* _edited = nullptr;
+        for (auto& _child : _root.objects()) {
+            const float _width = _child->width();
+            const float _min = _child->box.min.width, _max = _child->box.max.width;
+            _clamped += _width == _min || _width == _max;
+            if (!_edited && _width == _max && _min > 0 && _min < _max) _edited = _child.get();
+        }
+        std::cout << _scenario.name << ", " << items << " items, " << _clamped << " clamped\n";
+
+        const float _min = _edited->box.min.width;
+        measure("full", _root, 10, [&](std::size_t) { invalidateAll(_root); });
+        measure("incremental", _root, 50, [&](std::size_t i) {
+            _edited->box.min.width = i % 2 ? 0.f : _min;
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "Guijo/Utils/Utf8.hpp"
+
+using namespace Guijo;
+
+// Measures the text decoding used by text shaping and Font::width on
+// ASCII-heavy and mixed-script input. Prints throughput per approach.
+
+template<class Fun>
+double measure(std::string_view name, const std::string& text, std::size_t iterations, Fun&& fun) {
+    using namespace std::chrono;
+    volatile std::uint64_t _sink = 0;
+    auto _start = steady_clock::now();
+    for (std::size_t _i = 0; _i < iterations; ++_i) _sink = _sink + fun(text);
+    auto _elapsed = duration<double>(steady_clock::now() - _start).count();
+    double _throughput = (text.size() * iterations) / _elapsed / (1024. * 1024.);
+    std::cout << "  " << name << ": " << _throughput << " MiB/s\n";
+    return _throughput;
+}
+
+std::string generate(std::size_t bytes, double mixedRatio) {
+    // Words in a few scripts, mixed into mostly ASCII text
+    constexpr std::string_view _ascii[]{ "Value", "width", "Settings", "42", "Apply", "cancel" };
+    constexpr std::string_view _mixed[]{ "\xC3\xA9t\xC3\xA9", "\xD0\x9F\xD1\x80\xD0\xB8",
+        "\xE6\x97\xA5\xE6\x9C\xAC", "\xCE\xB1\xCE\xB2\xCE\xB3", "\xF0\x9F\x98\x80" };
+
+    std::string _text;
+    std::uint32_t _seed = 1;
+    const auto _random = [&] { return (_seed = _seed * 1664525 + 1013904223) >> 8; };
+    while (_text.size() < bytes) {
+        if ((_random() % 1000) / 1000. < mixedRatio) _text += _mixed[_random() % std::size(_mixed)];
+        else _text += _ascii[_random() % std::size(_ascii)];
+        _text += ' ';
+    }
+    return _text;
+}
+
+int main() {
+    constexpr std::size_t _iterations = 2000;
+    const std::pair<std::string_view, double> _inputs[]{
+        { "ascii", 0.0 }, { "ascii-heavy (2% non-ascii)", 0.02 }, { "mixed (50% non-ascii)", 0.5 },
+    };
+
+    for (auto& [_name, _ratio] : _inputs) {
+        for (std::size_t _size : { 16ull, 64ull, 4096ull }) {
+            auto _text = generate(_size, _ratio);
+            std::cout << _name << ", " << _text.size() << " bytes\n";
+
+            // Previous behaviour: iterate bytes, multi-byte sequences become garbage glyphs
+            measure("bytes (no decoding)", _text, _iterations * 4096 / _size, [](std::string_view s) {
+                std::uint64_t _sum = 0;
+                for (char _c : s) _sum += static_cast<unsigned char>(_c);
+                return _sum;
+            });
+
+            // Decoding every glyph through the scalar decoder
+            measure("scalar decode", _text, _iterations * 4096 / _size, [](std::string_view s) {
+                std::uint64_t _sum = 0;
+                for (std::size_t _i = 0; _i < s.size();) _sum += Utf8::next(s, _i);
+                return _sum;
+            });
+
+            // Vectorized ASCII runs, decoding only multi-byte sequences
+            measure("Utf8::forEach", _text, _iterations * 4096 / _size, [](std::string_view s) {
+                std::uint64_t _sum = 0;
+                Utf8::forEach(s, [&](char32_t c) { _sum += c; });
+                return _sum;
+            });
+        }
+    }
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "Guijo/pch.hpp"
+#include <span>
 #include "Guijo/Event/Event.hpp"
 #include "Guijo/Event/Key.hpp"
 #include "Guijo/Objects/EventReceiver.hpp"
@@ -13,75 +14,89 @@ namespace Guijo {
     };
     using MouseButtons = std::uint8_t;
 
-    struct MouseMove : Event {
+    struct MouseMove : TypedEvent<MouseMove> {
         MouseMove(Point<float> pos) : pos(pos) {}
         Point<float> pos{}; // New mouse position
+        std::span<Point<float>> history{}; // Positions coalesced into this one, oldest first
         bool forward(const EventReceiver& c) const override { return c.get(Hovering); };
+        void translate(Point<float> offset) override {
+            pos = pos + offset;
+            for (auto& _pos : history) _pos = _pos + offset;
+        }
     };
 
-    struct MouseDrag : Event {
+    struct MouseDrag : TypedEvent<MouseDrag> {
         MouseDrag(Point<float> source, Point<float> pos, MouseButtons buttons, KeyMod mod)
             : source(source), pos(pos), buttons(buttons), mod(mod) {}
         Point<float> source;  // Press position of cursor
         Point<float> pos;     // Position of cursor
         MouseButtons buttons; // Buttons held down
         KeyMod mod;           // Key mods
+        std::span<Point<float>> history{}; // Positions coalesced into this one, oldest first
         bool forward(const EventReceiver& c) const override { return c.get(Pressed); };
+        void translate(Point<float> offset) override {
+            source = source + offset, pos = pos + offset;
+            for (auto& _pos : history) _pos = _pos + offset;
+        }
     };
 
-    struct MouseEnter : Event {
+    struct MouseEnter : TypedEvent<MouseEnter> {
         bool forward(const EventReceiver& c) const override { return false; }
     };
 
-    struct MouseExit : Event {
+    struct MouseExit : TypedEvent<MouseExit> {
         bool forward(const EventReceiver& c) const override { return c.get(Hovering); }
     };
 
-    struct Focus : Event {
+    struct Focus : TypedEvent<Focus> {
         bool forward(const EventReceiver& c) const override { return false; }
     };
 
-    struct Unfocus : Event {
+    struct Unfocus : TypedEvent<Unfocus> {
         bool forward(const EventReceiver& c) const override { return true; }
     };
 
-    struct MousePress : Event {
+    struct MousePress : TypedEvent<MousePress> {
         MousePress(Point<float> pos, MouseButton button, KeyMod mod)
             : pos(pos), button(button), mod(mod) {}
         Point<float> pos;    // Position of press
         MouseButton button; // Button pressed
         KeyMod mod;         // Key mods
         bool forward(const EventReceiver& c) const override { return c.get(Hovering); };
+        void translate(Point<float> offset) override { pos = pos + offset; }
     };
 
-    struct MouseClick : Event {
+    struct MouseClick : TypedEvent<MouseClick> {
         MouseClick(Point<float> pos, MouseButton button, KeyMod mod)
             : pos(pos), button(button), mod(mod) {}
         Point<float> pos;    // Position of click
         MouseButton button; // Button used to click
         KeyMod mod;         // Key mods
         bool forward(const EventReceiver& c) const override { return c.get(Hovering); };
+        void translate(Point<float> offset) override { pos = pos + offset; }
     };
 
-    struct MouseWheel : public Event {
+    struct MouseWheel : TypedEvent<MouseWheel> {
         MouseWheel(Point<float> pos, int amount, KeyMod mod)
             : pos(pos), amount(amount), mod(mod) {}
         Point<float> pos;     // Cursor position when mousewheel was used
         std::int16_t amount; // Amount the mousewheel was used
         KeyMod mod;          // Key mods
         bool forward(const EventReceiver& c) const override { return c.get(Hovering); };
+        void translate(Point<float> offset) override { pos = pos + offset; }
     };
 
-    struct MouseRelease : Event {
+    struct MouseRelease : TypedEvent<MouseRelease> {
         MouseRelease(Point<float> pos, MouseButton button, KeyMod mod)
             : pos(pos), button(button), mod(mod) {}
         Point<float> pos;    // Position of the cursor
         MouseButton button; // Button that was released
         KeyMod mod;         // Key mods
         bool forward(const EventReceiver& c) const override { return c.get(Focused); };
+        void translate(Point<float> offset) override { pos = pos + offset; }
     };
 
-    struct KeyPress : public Event {
+    struct KeyPress : TypedEvent<KeyPress> {
         KeyPress(KeyCode code, KeyMod mod, bool repeat)
             : keycode(code), mod(mod), repeat(repeat) {}
         KeyCode keycode; // Key code
@@ -91,7 +106,7 @@ namespace Guijo {
         constexpr operator KeyCode() const { return keycode | mod; }
     };
 
-    struct KeyType : public Event {
+    struct KeyType : TypedEvent<KeyType> {
         KeyType(char key, KeyMod mod, bool coded)
             : key(key), mod(mod), coded(coded) {}
         char key;   // Character typed
@@ -100,7 +115,7 @@ namespace Guijo {
         bool forward(const EventReceiver& c) const override { return true; };
     };
 
-    struct KeyRelease : public Event {
+    struct KeyRelease : TypedEvent<KeyRelease> {
         KeyRelease(KeyCode code, KeyMod mod)
             : keycode(code), mod(mod) {}
         KeyCode keycode; // Key code of released key
@@ -2,6 +2,7 @@
 #include "Guijo/pch.hpp"
 #include "Guijo/Utils/Pointer.hpp"
 #include "Guijo/Utils/Utils.hpp"
+#include "Guijo/Utils/Vec.hpp"
 
 namespace Guijo {
     using State = std::int64_t;
@@ -13,107 +14,117 @@ namespace Guijo {
 
     class EventReceiver;
 
+    using EventId = std::size_t;
+
+    namespace detail {
+        inline EventId nextEventId() {
+            static std::atomic<EventId> _next = 0;
+            return _next++;
+        }
+    }
+
+    // Small number per event type, handlers are stored by it, so sending
+    // an event only calls the handlers of its type. Numbered on first use.
+    template<class Ty> EventId eventId() {
+        static const EventId _id = detail::nextEventId();
+        return _id;
+    }
+
     struct Event {
         virtual bool forward(const EventReceiver&) const = 0;
+        virtual void translate(Point<float>) {} // Move positions by an offset
+
+        constexpr EventId type() const { return m_Type; }
 
         constexpr void handle() const { m_Handled = true; }
         constexpr bool handled() const { return m_Handled; }
 
+    protected:
+        constexpr Event(EventId type) : m_Type(type) {}
+
     private:
+        EventId m_Type;
         mutable bool m_Handled = false;
     };
 
+    // Base of all events, handlers only match the exact type
+    template<class Self> struct TypedEvent : Event {
+        TypedEvent() : Event(eventId<Self>()) {}
+    };
+
+    namespace detail {
+        // Pick the receiver type handlers are called with, if any
+        template<bool Member, bool Self, auto Fun, class Args> auto handler_self() {
+            if constexpr (Member) return std::type_identity<member_function_type_t<decltype(Fun)>>{};
+            else if constexpr (Self) return std::type_identity<std::decay_t<std::tuple_element_t<0, Args>>>{};
+            else return std::type_identity<EventReceiver>{};
+        }
+    }
+
     struct EventHandler : public Refcounted {
-        virtual void handle(EventReceiver&, const Event&) const = 0;
+        virtual void handle(const Event&) const = 0;
     };
 
+    // Calls 'Fun' with the receiver it was registered on, cast once when
+    // registering, and events of its type, which it's only given.
     template<auto Fun> struct TypedEventHandler : public EventHandler {
-        void handle(EventReceiver& self, const Event& e) const override {
-            using signature = detail::signature_t<decltype(Fun)>;
-            using args = detail::function_args_t<signature>;
-            // Invocable immediately (static function/lambda)
-            if constexpr (detail::invocable_tuple_t<decltype(Fun), args>) {
-                if constexpr (std::tuple_size_v<args> == 1) { // No self argument
-                    using event_type = std::decay_t<std::tuple_element_t<0, args>>;
-                    if (auto _e = dynamic_cast<const event_type*>(&e)) Fun(*_e);
-                }
-                else {
-                    using self_type = std::decay_t<std::tuple_element_t<0, args>>;
-                    using event_type = std::decay_t<std::tuple_element_t<1, args>>;
-                    if (auto _self = dynamic_cast<self_type*>(&self))
-                        if (auto _e = dynamic_cast<const event_type*>(&e)) Fun(*_self, *_e);
-                }
-            }
-            else { // Otherwise member function
-                using self_type = detail::member_function_type_t<decltype(Fun)>;
-                using event_type = std::decay_t<std::tuple_element_t<0, args>>;
-                if (auto _self = dynamic_cast<self_type*>(&self))
-                    if (auto _e = dynamic_cast<const event_type*>(&e)) (_self->*Fun)(*_e);
-            }
+        using signature = detail::signature_t<decltype(Fun)>;
+        using args = detail::function_args_t<signature>;
+        // Invocable immediately (static function/lambda), otherwise member function
+        constexpr static bool member = !detail::invocable_tuple_t<decltype(Fun), args>;
+        constexpr static bool self = member || std::tuple_size_v<args> == 2;
+        using self_type = typename decltype(detail::handler_self<member, self, Fun, args>())::type;
+        using event_type = std::decay_t<std::tuple_element_t<self && !member ? 1 : 0, args>>;
+        static_assert(std::derived_from<event_type, TypedEvent<event_type>>, "Events derive from TypedEvent<Event>");
+
+        self_type& receiver;
+        TypedEventHandler(self_type& receiver) : receiver(receiver) {}
+
+        void handle(const Event& e) const override {
+            auto& _e = static_cast<const event_type&>(e);
+            if constexpr (member) (receiver.*Fun)(_e);
+            else if constexpr (self) Fun(receiver, _e);
+            else Fun(_e);
         };
     };
 
     struct StateHandler : public Refcounted {
-        virtual State handle(EventReceiver&, const Event&, EventReceiver&, State) const = 0;
+        virtual State handle(const Event&, EventReceiver&, State) const = 0;
     };
 
+    // Same as event handlers, for 'Fun' that return the state of a child
     template<auto Fun> struct TypedStateHandler : public StateHandler {
+        using signature = detail::signature_t<decltype(Fun)>;
+        using args = detail::function_args_t<signature>;
+        // Invocable immediately (static function/lambda), otherwise member function
+        constexpr static bool member = !detail::invocable_tuple_t<decltype(Fun), args>;
+        constexpr static bool counts = member || std::same_as<State, detail::last_t<args>>; // Has matched argument at end
+        constexpr static bool self = member || std::tuple_size_v<args> == (counts ? 4 : 3);
+        using self_type = typename decltype(detail::handler_self<member, self, Fun, args>())::type;
+        constexpr static std::size_t first = self && !member ? 1 : 0;
+        using event_type = std::decay_t<std::tuple_element_t<first, args>>;
+        using component_type = std::decay_t<std::tuple_element_t<first + 1, args>>;
+        static_assert(std::derived_from<event_type, TypedEvent<event_type>>, "Events derive from TypedEvent<Event>");
+
         const std::size_t state{};
-        TypedStateHandler(std::size_t state) : state(state) {}
-        State handle(EventReceiver& self,
-            const Event& e, EventReceiver& c, State matches) const override {
-            using signature = detail::signature_t<decltype(Fun)>;
-            using args = detail::function_args_t<signature>;
-            // Invocable immediately (static function/lambda)
-            if constexpr (detail::invocable_tuple_t<decltype(Fun), args>) {
-                // Has matched argument at end
-                if constexpr (std::same_as<State, detail::last_t<args>>) {
-                    if constexpr (std::tuple_size_v<args> == 3) { // No self argument
-                        using event_type = std::decay_t<std::tuple_element_t<0, args>>;
-                        using component_type = std::decay_t<std::tuple_element_t<1, args>>;
-                        if (auto _e = dynamic_cast<const event_type*>(&e))
-                            if (auto _c = dynamic_cast<component_type*>(&c))
-                                return _c->set(state, Fun(*_e, *_c, matches));
-                    }
-                    else {
-                        using self_type = std::decay_t<std::tuple_element_t<0, args>>;
-                        using event_type = std::decay_t<std::tuple_element_t<1, args>>;
-                        using component_type = std::decay_t<std::tuple_element_t<2, args>>;
-                        if (auto _self = dynamic_cast<self_type*>(&self))
-                            if (auto _e = dynamic_cast<const event_type*>(&e))
-                                if (auto _c = dynamic_cast<component_type*>(&c))
-                                    return _c->set(state, Fun(*_self, *_e, *_c, matches));
-                    }
-                }
-                else {
-                    if constexpr (std::tuple_size_v<args> == 2) { // No matches argument
-                        using event_type = std::decay_t<std::tuple_element_t<0, args>>;
-                        using component_type = std::decay_t<std::tuple_element_t<1, args>>;
-                        if (auto _e = dynamic_cast<const event_type*>(&e))
-                            if (auto _c = dynamic_cast<component_type*>(&c))
-                                _c->set(state, Fun(*_e, *_c));
-                    }
-                    else {
-                        using self_type = std::decay_t<std::tuple_element_t<0, args>>;
-                        using event_type = std::decay_t<std::tuple_element_t<1, args>>;
-                        using component_type = std::decay_t<std::tuple_element_t<2, args>>;
-                        if (auto _self = dynamic_cast<self_type*>(&self))
-                            if (auto _e = dynamic_cast<const event_type*>(&e))
-                                if (auto _c = dynamic_cast<component_type*>(&c))
-                                    _c->set(state, Fun(*_self, *_e, *_c));
-                    }
-                }
-            }
-            else { // Otherwise member function
-                using self_type = detail::member_function_type_t<decltype(Fun)>;
-                using event_type = std::decay_t<std::tuple_element_t<0, args>>;
-                using component_type = std::decay_t<std::tuple_element_t<1, args>>;
-                if (auto _self = dynamic_cast<self_type*>(&self))
-                    if (auto _e = dynamic_cast<const event_type*>(&e))
-                        if (auto _c = dynamic_cast<component_type*>(&c))
-                            return _c->set(state, (_self->*Fun)(*_e, *_c, matches));
+        self_type& receiver;
+        TypedStateHandler(std::size_t state, self_type& receiver) : state(state), receiver(receiver) {}
+
+        State handle(const Event& e, EventReceiver& c, State matches) const override {
+            auto& _e = static_cast<const event_type&>(e);
+            component_type* _c = nullptr;
+            if constexpr (std::same_as<component_type, EventReceiver>) _c = &c;
+            else if (!(_c = dynamic_cast<component_type*>(&c))) return 0;
+
+            if constexpr (member) return _c->set(state, (receiver.*Fun)(_e, *_c, matches));
+            else if constexpr (counts) {
+                if constexpr (self) return _c->set(state, Fun(receiver, _e, *_c, matches));
+                else return _c->set(state, Fun(_e, *_c, matches));
+            } else { // Without matched argument it doesn't count as a match
+                if constexpr (self) _c->set(state, Fun(receiver, _e, *_c));
+                else _c->set(state, Fun(_e, *_c));
+                return 0;
             }
-            return 0;
         };
     };
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include "Guijo/Event/BasicEvents.hpp"
+
+namespace Guijo {
+    // Fixed capacity ring buffer of the built-in events, stored by value so
+    // queueing input never allocates. A move or drag right after another of
+    // the same kind replaces its position instead of queueing, so only the
+    // latest gets dispatched. With 'history' on, the positions it replaced
+    // are kept in the event's history, as far as there's room, for pen input.
+    class EventQueue {
+    public:
+        using Stored = std::variant<MouseEnter, MouseExit, Focus, Unfocus, // Default constructible first
+            MouseMove, MouseDrag, MousePress, MouseClick, MouseWheel, MouseRelease,
+            KeyPress, KeyType, KeyRelease>;
+
+        constexpr static std::size_t Capacity = 256;
+        constexpr static std::size_t HistoryCapacity = 1024;
+
+        bool history = false; // Keep the positions coalesced moves and drags replaced
+
+        bool empty() const { return m_Size == 0; }
+        bool full() const { return m_Size == Capacity; }
+        std::size_t size() const { return m_Size; }
+
+        // Queue an event, false when full. Never coalesces into the front
+        // once it's taken, it may be dispatching.
+        template<class Ty> bool push(const Ty& e) {
+            if constexpr (std::same_as<Ty, MouseMove> || std::same_as<Ty, MouseDrag>) {
+                if (m_Size > (m_Taken ? 1 : 0)) {
+                    if (auto _last = std::get_if<Ty>(&back()); _last && coalesces(*_last, e)) {
+                        remember(*_last);
+                        _last->pos = e.pos;
+                        return true;
+                    }
+                }
+            }
+
+            if (full()) return false;
+            m_Events[(m_First + m_Size++) % Capacity] = e;
+            m_HistoryStart = m_HistorySize; // History of the new back starts here
+            return true;
+        }
+
+        // Oldest event, stays queued until popped
+        Event& front() {
+            m_Taken = true;
+            return std::visit([](auto& e) -> Event& { return e; }, m_Events[m_First]);
+        }
+
+        void pop() {
+            m_First = (m_First + 1) % Capacity, --m_Size;
+            m_Taken = false;
+            if (empty()) m_HistoryStart = m_HistorySize = 0; // Nothing refers to it anymore
+        }
+
+    private:
+        std::array<Stored, Capacity> m_Events{};
+        std::size_t m_First = 0;
+        std::size_t m_Size = 0;
+        bool m_Taken = false; // Front was handed out, but not popped yet
+
+        std::array<Point<float>, HistoryCapacity> m_History{};
+        std::size_t m_HistoryStart = 0; // Where the history of the back starts
+        std::size_t m_HistorySize = 0;
+
+        Stored& back() { return m_Events[(m_First + m_Size - 1) % Capacity]; }
+
+        static bool coalesces(const MouseMove&, const MouseMove&) { return true; }
+        static bool coalesces(const MouseDrag& a, const MouseDrag& b) {
+            return a.source == b.source && a.buttons == b.buttons && a.mod == b.mod;
+        }
+
+        template<class Ty> void remember(Ty& e) {
+            if (!history || m_HistorySize == HistoryCapacity) return;
+            m_History[m_HistorySize++] = e.pos;
+            e.history = { m_History.data() + m_HistoryStart, m_HistorySize - m_HistoryStart };
+        }
+    };
+}
\ No newline at end of file
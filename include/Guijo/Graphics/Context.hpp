@@ -43,7 +43,26 @@ namespace Guijo {
             return _ptr;
         }
 
-        void reset() { counter = 0; }
+        // Copies strings that commands refer to, they have to outlive the
+        // objects that drew them when the frame is presented later. Chunks
+        // never grow past their capacity, so the views stay valid.
+        std::vector<std::string> strings;
+        std::size_t chunk = 0ull;
+
+        std::string_view store(std::string_view str) {
+            while (chunk < strings.size() && strings[chunk].capacity() - strings[chunk].size() < str.size()) ++chunk;
+            if (chunk == strings.size()) strings.emplace_back().reserve(std::max<std::size_t>(4096, str.size()));
+            auto& _chunk = strings[chunk];
+            const std::size_t _at = _chunk.size();
+            _chunk.append(str);
+            return { _chunk.data() + _at, str.size() };
+        }
+
+        void reset() { 
+            counter = 0;
+            for (auto& _chunk : strings) _chunk.clear();
+            chunk = 0;
+        }
     };
 
     // Converts trivially destructible types into a unique ptr of raw bytes
@@ -62,6 +81,7 @@ namespace Guijo {
         Text, FontSize, SetFont, TextAlign,
         Translate, PushMatrix, PopMatrix, Viewport,
         Clip, PushClip, PopClip, ClearClip,
+        PushLayer, PopLayer,
         Amount
     };
     using enum Commands;
@@ -86,6 +106,14 @@ namespace Guijo {
     template<> struct Command<PushClip> { };
     template<> struct Command<PopClip> { };
     template<> struct Command<ClearClip> { };
+    template<> struct Command<PushLayer> {
+        std::size_t id;             // Identifies the layer between frames
+        Dimensions<float> area;     // Part of the window it covers
+        Point<float> scrolled{};    // Contents are drawn moved by minus this
+        std::size_t hash = 0;       // Of the commands in the layer, set by popLayer
+        std::size_t commands = 0;   // Amount of commands in the layer, set by popLayer
+    };
+    template<> struct Command<PopLayer> { };
 
     struct CommandData {
         template<Commands Ty> CommandData(MemoryPool& pool, const Command<Ty>& val)
@@ -100,6 +128,57 @@ namespace Guijo {
         }
     };
 
+    // Hash of the commands in a layer, over the values they hold. Padding
+    // and where strings are stored change every frame, so neither is added.
+    // FNV-1a over words instead of bytes, every step can be undone, so any
+    // single change in the commands changes the hash.
+    struct CommandHash {
+        std::size_t value = 14695981039346656037ull;
+
+        void add(const void* data, std::size_t bytes) {
+            auto _bytes = static_cast<const std::uint8_t*>(data);
+            std::size_t _i = 0;
+            for (; _i + sizeof(std::uint64_t) <= bytes; _i += sizeof(std::uint64_t)) {
+                std::uint64_t _word;
+                std::memcpy(&_word, _bytes + _i, sizeof(_word));
+                value = (value ^ _word) * 1099511628211ull;
+                value ^= value >> 32; // High bits of the word reach the low bits
+            }
+            for (; _i < bytes; ++_i) 
+                value = (value ^ _bytes[_i]) * 1099511628211ull;
+        }
+
+        template<class Ty> requires (std::is_arithmetic_v<Ty> || std::is_enum_v<Ty>)
+        void add(Ty v) { add(&v, sizeof(Ty)); }
+        void add(std::string_view v) { add(v.size()), add(v.data(), v.size()); }
+        template<class Ty> void add(const Radians<Ty>& v) { add(v.radians()); }
+        template<class Type, std::size_t N, class Ty> 
+        void add(const VecBase<Type, N, Ty>& v) { for (auto& _v : v.m_Data) add(_v); }
+
+        template<Commands Ty> requires std::is_empty_v<Command<Ty>> void add(const Command<Ty>&) {}
+        void add(const Command<Fill>& v) { add(v.color); }
+        void add(const Command<Stroke>& v) { add(v.color); }
+        void add(const Command<StrokeWeight>& v) { add(v.weight); }
+        void add(const Command<Rect>& v) { add(v.dimensions), add(v.radius), add(v.rotation); }
+        void add(const Command<Line>& v) { add(v.start), add(v.end), add(v.cap); }
+        void add(const Command<Circle>& v) { add(v.center), add(v.radius), add(v.angles); }
+        void add(const Command<Triangle>& v) { add(v.a), add(v.b), add(v.c); }
+        void add(const Command<Text>& v) { add(v.text), add(v.pos); }
+        void add(const Command<FontSize>& v) { add(v.size); }
+        void add(const Command<SetFont>& v) { add(v.font); }
+        void add(const Command<TextAlign>& v) { add(v.align); }
+        void add(const Command<Translate>& v) { add(v.translate); }
+        void add(const Command<Viewport>& v) { add(v.viewport); }
+        void add(const Command<Clip>& v) { add(v.clip); }
+        void add(const Command<PushLayer>& v) { add(v.id), add(v.area), add(v.scrolled), add(v.hash), add(v.commands); }
+
+        template<std::size_t ...Is>
+        void add(CommandData& c, std::index_sequence<Is...>) {
+            add(c.type);
+            ((c.type == static_cast<Commands>(Is) ? (add(c.get<static_cast<Commands>(Is)>()), true) : false) || ...);
+        }
+    };
+
     class DrawContext {
         friend class GraphicsBase;
     public:
@@ -111,9 +190,9 @@ namespace Guijo {
         void line(const Command<Line>& v) { m_Commands.emplace_back(memPool, v); }
         void circle(const Command<Circle>& v) { m_Commands.emplace_back(memPool, v); }
         void triangle(const Command<Triangle>& v) { m_Commands.emplace_back(memPool, v); }
-        void text(const Command<Text>& v) { m_Commands.emplace_back(memPool, v); }
+        void text(const Command<Text>& v) { m_Commands.emplace_back(memPool, Command<Text>{ memPool.store(v.text), v.pos }); }
         void fontSize(const Command<FontSize>& v) { m_Commands.emplace_back(memPool, v); }
-        void font(const Command<SetFont>& v) { m_Commands.emplace_back(memPool, v); }
+        void font(const Command<SetFont>& v) { m_Commands.emplace_back(memPool, Command<SetFont>{ memPool.store(v.font) }); }
         void textAlign(const Command<TextAlign>& v) { m_Commands.emplace_back(memPool, v); }
         void translate(const Command<Translate>& v) { m_Commands.emplace_back(memPool, v); }
         void pushMatrix() { m_Commands.emplace_back(memPool, Command<PushMatrix>{}); }
@@ -123,6 +202,28 @@ namespace Guijo {
         void pushClip() { m_Commands.emplace_back(memPool, Command<PushClip>{}); }
         void popClip() { m_Commands.emplace_back(memPool, Command<PopClip>{}); }
         void clearClip() { m_Commands.emplace_back(memPool, Command<ClearClip>{}); }
+        
+        // The renderer keeps the pixels drawn between pushLayer and popLayer,
+        // when the commands in between are the same as last frame it only
+        // moves them by the change in scroll and draws the exposed part.
+        void pushLayer(const Command<PushLayer>& v) {
+            m_Layers.push_back(m_Commands.size());
+            m_Commands.emplace_back(memPool, v);
+        }
+
+        void popLayer() {
+            const std::size_t _begin = m_Layers.back();
+            m_Layers.pop_back();
+
+            CommandHash _hash;
+            for (std::size_t _i = _begin + 1; _i < m_Commands.size(); ++_i)
+                _hash.add(m_Commands[_i], std::make_index_sequence<static_cast<std::size_t>(Commands::Amount)>{});
+
+            auto& _layer = m_Commands[_begin].get<Commands::PushLayer>();
+            _layer.hash = _hash.value;
+            _layer.commands = m_Commands.size() - _begin - 1;
+            m_Commands.emplace_back(memPool, Command<PopLayer>{});
+        }
 
         void fill(const Color& v) {
             m_Commands.emplace_back(memPool, Command<Fill>{ v });
@@ -153,7 +254,7 @@ namespace Guijo {
         }
 
         void text(std::string_view text, const Point<float>& pos) { 
-            m_Commands.emplace_back(memPool, Command<Text>{ text, pos });
+            m_Commands.emplace_back(memPool, Command<Text>{ memPool.store(text), pos });
         }
 
         void fontSize(float size) { 
@@ -161,7 +262,7 @@ namespace Guijo {
         }
 
         void font(std::string_view font) {
-            m_Commands.emplace_back(memPool, Command<SetFont>{ font });
+            m_Commands.emplace_back(memPool, Command<SetFont>{ memPool.store(font) });
         }
 
         void textAlign(Alignment align) { 
@@ -187,5 +288,6 @@ namespace Guijo {
     private:
         MemoryPool memPool;
         std::vector<CommandData> m_Commands;
+        std::vector<std::size_t> m_Layers; // Indices of the pushed layers
     };
 }
\ No newline at end of file
@@ -1,12 +1,32 @@
 #pragma once
 #include "Guijo/pch.hpp"
 #include "Guijo/Utils/Vec.hpp"
+#include "Guijo/Graphics/GlyphCache.hpp"
 
 namespace Guijo {
     class Font {
         static inline FT_Library library;
         static inline int references = 0;
 
+    public:
+        constexpr static std::size_t PageSize = 128; // Codepoints per glyph page
+
+        // Codepoints a font has glyphs for, 1 bit per codepoint. Built once
+        // from the font's charmap, so picking a font is a single bit test.
+        class Coverage {
+        public:
+            void add(char32_t c);
+            bool contains(char32_t c) const {
+                const std::size_t _word = c / 64;
+                return _word < m_Bits.size() && (m_Bits[_word] >> (c % 64)) & 1;
+            }
+
+            std::size_t count() const; // Amount of covered codepoints
+
+        private:
+            std::vector<std::uint64_t> m_Bits{};
+        };
+
         struct CharMap {
             struct Character {
                 unsigned int index = static_cast<unsigned int>(-1);
@@ -15,45 +35,144 @@ namespace Guijo {
                 unsigned int advance{};
             };
 
-            CharMap(int size, FT_Face& face);
+            // Glyphs are loaded in pages of consecutive codepoints, every
+            // page has its own texture array with 1 layer per glyph.
+            struct Page {
+                unsigned int texture = 0; // Created by upload(), on the render thread
+                std::uint64_t used = 0;   // Frame this page was last used in
+                Character characters[PageSize]{};
+                std::vector<unsigned char> pixels{}; // Rendered, not uploaded yet
+                GlyphCache::Mapping mapping{};       // Or mapped from the glyph cache
+            };
+
+            CharMap(int size, FT_Face& face, std::uint64_t hash);
+            CharMap(const CharMap&) = delete;
+            ~CharMap();
+
+            Character& character(char32_t c);
+            Page& page(char32_t page); // Page containing codepoints [page * 128, page * 128 + 128)
 
-            Character& character(char c);
+            // Texture of the page, uploads its glyphs the first time. Needs
+            // the GL context, so only the render thread calls it.
+            unsigned int texture(Page& page);
 
             float height() const { return m_Ascender - m_Descender; }
             float ascender() const { return m_Ascender; }
             float descender() const { return m_Descender; }
             float middle() const { return (m_Size + m_Descender) / 2; }
 
-            unsigned int texture;
-
         private:
             void initialize();
+            void load(Page& page, char32_t id);
+            bool loadFromCache(Page& page, char32_t id);
+            void release(char32_t id);
+
+            std::size_t textureBytes() const { return static_cast<std::size_t>(m_Size) * m_Size * 4 * PageSize; }
 
-            Character m_CharMap[128]{};
+            std::unordered_map<char32_t, Page> m_Pages{};
+            Page* m_Ascii = nullptr; // Page 0, looked up directly
             int m_Size{};
             float m_Ascender{};
             float m_Descender{};
             float m_Height{};
+            std::uint64_t m_Hash{};
             FT_Face& m_Face;
+
+            friend class Font;
         };
 
-    public:
+        // Memory held by the glyph pages of all fonts and sizes
+        struct Usage {
+            std::size_t cpu = 0;       // Glyph metrics
+            std::size_t gpu = 0;       // Texture arrays
+            std::size_t pages = 0;     // Currently loaded pages
+            std::size_t sizes = 0;     // Currently loaded character maps
+            std::size_t evictions = 0; // Pages evicted since start
+
+            std::size_t bytes() const { return cpu + gpu; }
+        };
+
+        // Budget for glyph pages (CPU and GPU bytes) of all fonts and sizes
+        // combined. Least recently used pages are evicted when exceeded,
+        // they are loaded again (usually from the glyph cache) when needed.
+        // Eviction goes down to 'retain' of the budget, so a working set
+        // around the budget doesn't evict and reload pages every frame.
+        static inline std::size_t budget = 64 * 1024 * 1024;
+        static inline double retain = 0.75;
+        static const Usage& usage() { return memory; }
+
+        // Start a new frame for the page usage. Called once per Gui::loop,
+        // before any window renders, so all windows share the frame.
+        static void tick();
+
+        // Evict least recently used pages when over budget, pages used in
+        // the current frame are never evicted. Called once per Gui::loop
+        // after the windows rendered. Deletes textures, so only the render
+        // thread calls it.
+        static void evict();
+
+        // Layout on worker threads measures text while the render thread
+        // draws it. Fonts, their glyph metrics and the text run cache are
+        // guarded by this lock: width() takes it, and so does the renderer
+        // while it selects fonts and draws text. Loading a page only reads
+        // the font and renders into memory; textures are created by the
+        // render thread when it first draws the page.
+        static std::unique_lock<std::mutex> lock() { return std::unique_lock{ mutex }; }
+
         static inline std::string_view Default = "segoeui";
+
+        // Fonts tried, in order, after a font's own fallbacks when it has
+        // no glyph for a codepoint. Loaded by name once a codepoint isn't
+        // covered by the fonts before them.
+        static inline std::vector<std::string> Fallback{
+            "seguisym", "seguiemj", "Nirmala", "msyh", "YuGothM", "malgun", "ebrima",
+        };
+
         static void load(std::string_view path, std::string_view name);
         static bool load(std::string_view name);
         static float width(const char c, std::string_view font, float size);
         static float width(std::string_view c, std::string_view font, float size);
 
+        std::vector<std::string> fallback{}; // Fonts tried before Font::Fallback
+
         Font(std::string_view path);
         Font(const Font& other);
         ~Font();
 
         CharMap& size(int size);
 
+        const Coverage& coverage() const { return m_Coverage; }
+
+        // This font followed by a slot per fallback name, null until select()
+        // needed it, or when it wasn't found. Names are only looked up again
+        // once they change.
+        const std::vector<Font*>& chain();
+
+        // Changes every time the chain starts over with new fallback names
+        std::size_t generation() { chain(); return m_Generation; }
+
+        // Index in chain() of the first font that has a glyph for 'c', or 0
+        // when none do, so this font's missing glyph is used. Fallbacks are
+        // loaded in order, only when the fonts before them lack 'c'.
+        std::size_t select(char32_t c);
+
     private:
         std::string m_Path{};
+        std::uint64_t m_Hash{};
         FT_Face m_Face{};
+        Coverage m_Coverage{};
 
         std::map<int, CharMap> m_SizeMap{};
+
+        std::vector<Font*> m_Chain{};
+        std::vector<std::string> m_ChainNames{}; // Names m_Chain was resolved from
+        std::size_t m_Resolved = 0; // Slots of m_Chain looked up so far, always the first ones
+        std::size_t m_Generation = 0;
+
+        static inline std::mutex mutex{};
+        static inline std::uint64_t frame = 1; // Increments every tick()
+        static Usage memory;
+
+        static std::filesystem::path find(std::string_view name); // Empty if not found
     };
 }
\ No newline at end of file
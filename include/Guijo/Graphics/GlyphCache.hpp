@@ -0,0 +1,89 @@
+#pragma once
+#include "Guijo/pch.hpp"
+
+namespace Guijo {
+    // On-disk cache of rasterized glyph maps. Every entry is keyed by the
+    // font file's key, pixel size and render mode, and stored as a flat file
+    // (header, glyph metrics, texture layers) that is memory mapped on load,
+    // so a warm start can upload the layers without touching FreeType.
+    class GlyphCache {
+    public:
+        constexpr static std::uint32_t Magic = 0x4A594C47; // 'GLYJ'
+        constexpr static std::uint32_t Version = 2;
+
+        struct Key {
+            std::uint64_t font{};     // Key of the font file, see fontKey()
+            std::int32_t size{};      // Pixel size
+            std::int32_t mode{};      // FreeType render mode
+            std::int32_t page{};      // Codepoint page (codepoint / count)
+            std::int32_t reserved{};
+        };
+
+        struct Header {
+            std::uint32_t magic = Magic;
+            std::uint32_t version = Version;
+            Key key{};
+            std::int32_t width{};     // Width of a single layer
+            std::int32_t height{};    // Height of a single layer
+            std::int32_t count{};     // Amount of layers (glyphs)
+            float ascender{};
+            float descender{};
+            float lineHeight{};
+            std::uint64_t checksum{}; // Hash of glyphs + pixels
+        };
+
+        struct Glyph {
+            std::uint32_t index{};
+            std::int32_t width{};
+            std::int32_t height{};
+            std::int32_t bearingX{};
+            std::int32_t bearingY{};
+            std::uint32_t advance{};
+        };
+
+        // Read-only view of a validated cache file, unmapped on destruction
+        class Mapping {
+        public:
+            Mapping() = default;
+            Mapping(Mapping&& other) noexcept;
+            Mapping& operator=(Mapping&& other) noexcept;
+            ~Mapping();
+
+            explicit operator bool() const { return m_Data != nullptr; }
+
+            const Header& header() const { return *reinterpret_cast<const Header*>(m_Data); }
+            const Glyph* glyphs() const { return reinterpret_cast<const Glyph*>(m_Data + sizeof(Header)); }
+            const std::uint8_t* pixels() const { return m_Data + sizeof(Header) + header().count * sizeof(Glyph); }
+
+        private:
+            const std::uint8_t* m_Data = nullptr;
+            std::size_t m_Size = 0;
+#ifdef WIN32
+            HANDLE m_File = INVALID_HANDLE_VALUE;
+            HANDLE m_Map = nullptr;
+#endif
+            void release();
+            friend class GlyphCache;
+        };
+
+        static inline bool enabled = true;         // Toggle the on-disk cache
+        static inline std::string directory = "";  // Empty: use default location
+
+        static std::uint64_t hash(const std::uint8_t* data, std::size_t size, std::uint64_t seed = Offset);
+        // Identifies a font file by its path, size and modification time,
+        // without reading it. Fonts can be tens of megabytes.
+        static std::uint64_t fontKey(std::string_view path);
+
+        static std::filesystem::path root(); // Directory the cache files are in
+
+        static Mapping open(const Header& expected);
+        static bool store(const Header& header, const Glyph* glyphs, const std::uint8_t* pixels);
+
+    private:
+        constexpr static std::uint64_t Offset = 0xcbf29ce484222325ull;
+        constexpr static std::uint64_t Prime = 0x100000001b3ull;
+
+        static std::filesystem::path path(const Key& key);
+        static std::size_t pixelBytes(const Header& header);
+    };
+}
\ No newline at end of file
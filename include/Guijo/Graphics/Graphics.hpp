@@ -2,6 +2,7 @@
 #include "Guijo/Graphics/Context.hpp"
 #include "Guijo/Graphics/Font.hpp"
 #include "Guijo/Graphics/Shader.hpp"
+#include "Guijo/Graphics/TextRun.hpp"
 
 namespace Guijo {
     class GraphicsBase {
@@ -10,17 +11,30 @@ namespace Guijo {
         GraphicsBase(GraphicsBase&&) = delete;
         GraphicsBase(const GraphicsBase&) = delete;
 
-        void render();
+        void render(); // Draw the committed commands
+
+        // Hand the recorded commands to render(), they stay committed until
+        // the next commit. Recording continues in the other buffer, so a
+        // committed frame can be rendered again or while the next is made.
+        void commit();
 
         virtual void dimensions(const Dimensions<float>&);
 
         virtual void prepare() = 0; // Prepare for drawing (i.e. context switching)
         virtual void swapBuffers() = 0;
 
+        static inline TextRunCache TextRuns{}; // Shaped text, shared by all contexts
+
     protected:
         static std::map<std::string, Guijo::Font, std::less<>> Fonts;
 
-        DrawContext context;
+        // Commands refer to the memory pool of their context, so contexts
+        // take turns recording instead of moving their commands.
+        std::array<DrawContext, 2> contexts{};
+        std::size_t recording = 0; // Context being recorded, the other one is committed
+
+        DrawContext& context() { return contexts[recording]; }
+        DrawContext& committed() { return contexts[1 - recording]; }
 
         std::stack<Dimensions<float>> clipStack;
         Dimensions<float> clip{};
@@ -38,6 +52,10 @@ namespace Guijo {
         float fontSize = 16;
         Alignment textAlign = Align::Left | Align::Bottom;
 
+        // Index of the next command to render, layers that kept their
+        // pixels move it past their contents.
+        std::size_t resume = 0;
+
         template<std::size_t ...Is> 
         void runCommand(CommandData& c, std::index_sequence<Is...>) {
             ((c.type == static_cast<Commands>(Is) ? (runCommand(
@@ -63,6 +81,8 @@ namespace Guijo {
         virtual void runCommand(Command<PushClip>&) = 0;
         virtual void runCommand(Command<PopClip>&) = 0;
         virtual void runCommand(Command<ClearClip>&) = 0;
+        virtual void runCommand(Command<PushLayer>&) = 0;
+        virtual void runCommand(Command<PopLayer>&) = 0;
 
         friend class Font;
         friend class Window;
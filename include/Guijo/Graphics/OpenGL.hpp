@@ -15,15 +15,17 @@ namespace Guijo {
         void runCommand(Command<PushClip>&) override;
         void runCommand(Command<PopClip>&) override;
         void runCommand(Command<ClearClip>&) override;
+        void runCommand(Command<PushLayer>&) override;
+        void runCommand(Command<PopLayer>&) override;
 
         ~Graphics();
     private:
         static inline Graphics* mainContext = nullptr;
-        static inline HGLRC current = nullptr;
-        HGLRC m_Context = nullptr;
         static inline std::mutex m_Lock;
 
 #ifdef WIN32
+        static inline HGLRC current = nullptr;
+        HGLRC m_Context = nullptr;
         HDC m_Device = nullptr;
         void initialize(HDC handle);
 #endif
@@ -45,5 +47,42 @@ namespace Guijo {
         Buffer circle;
         Buffer triangle;
         Buffer text;
+        unsigned int textInstances; // Per-glyph instance data for text
+
+        // State the contents of a layer start with, drawn differently when changed
+        struct Inherited {
+            glm::vec4 fill;
+            glm::vec4 stroke;
+            float strokeWeight;
+            float fontSize;
+            Font* font;
+            Alignment align;
+
+            bool operator==(const Inherited&) const = default;
+        };
+
+        struct Layer {
+            unsigned int framebuffers[2]{};
+            unsigned int textures[2]{};
+            std::size_t front = 0;       // Texture with the last contents
+            Dimensions<float> area{};    // In pixels, flipped like clips
+            Point<float> scrolled{};     // Scroll offset the contents were drawn at
+            std::size_t hash = 0;        // Hash of the commands they were drawn with
+            Inherited inherited{};
+            bool used = false;           // Rendered since the last prepare
+        };
+
+        struct Target {
+            Layer* layer = nullptr;      // Nothing is drawn when the area is empty
+            Dimensions<float> clip{};    // Clip outside the layer
+        };
+
+        std::unordered_map<std::size_t, Layer> layers;
+        std::vector<Target> targets;     // Layers being drawn, innermost last
+        Point<float> origin{ 0, 0 };     // Position of the drawn layer in the window, in pixels
+
+        void release(Layer&);
+        void scissor();                  // Apply the clip to the drawn layer or window
+        void blending();                 // Default blending of the drawn layer or window
     };
 }
\ No newline at end of file
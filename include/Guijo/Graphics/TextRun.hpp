@@ -0,0 +1,76 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include "Guijo/Graphics/Context.hpp"
+#include "Guijo/Graphics/Font.hpp"
+
+namespace Guijo {
+    // Shaped string: glyph layers and positions relative to the pen
+    // origin, with alignment already applied.
+    struct TextRun {
+        struct Glyph {
+            float x;       // Pen offset from pen origin, scales with the transform
+            float y;       // Offset from pen origin
+            float layer;   // Layer in the font's texture array
+            float bearing; // Horizontal offset from the pen, doesn't scale
+        };
+
+        // Consecutive glyphs that share a font and glyph page (texture)
+        struct Batch {
+            Font* font; // Font in the fallback chain
+            char32_t page;
+            std::uint32_t first;
+            std::uint32_t count;
+        };
+
+        std::vector<Glyph> glyphs{};   // Grouped by font and page
+        std::vector<Batch> batches{};
+        float width = 0; // Total advance of the run
+    };
+
+    // Caches shaped text runs by (string, font, fallback chain, size,
+    // alignment), so static labels are only shaped once instead of every
+    // frame. Changing the fallbacks of a font shapes its runs again.
+    class TextRunCache {
+    public:
+        struct Statistics {
+            std::size_t hits = 0;
+            std::size_t misses = 0;
+            std::size_t evictions = 0;
+            std::size_t bytes = 0;   // Current memory usage
+            std::size_t entries = 0; // Current amount of runs
+
+            double hitRate() const {
+                return hits + misses == 0 ? 0. : static_cast<double>(hits) / (hits + misses);
+            }
+        };
+
+        std::size_t budget = 4 * 1024 * 1024; // Memory budget in bytes
+
+        const TextRun& get(std::string_view text, Font& font, float size, Alignment align);
+
+        void clear();
+        void resetStatistics();
+        const Statistics& statistics() const { return m_Statistics; }
+
+    private:
+        struct Entry {
+            std::string text;
+            Font* font;
+            std::size_t generation; // Of the font's fallback chain
+            float size;
+            Alignment align;
+            std::size_t hash;
+            std::size_t bytes;
+            TextRun run;
+        };
+
+        std::list<Entry> m_Entries{}; // Most recently used at the front
+        std::unordered_map<std::size_t, std::list<Entry>::iterator> m_Lookup{};
+        Statistics m_Statistics{};
+
+        static std::size_t hash(std::string_view text, Font* font, std::size_t generation, float size, Alignment align);
+        static void shape(Entry& entry);
+        void erase(std::list<Entry>::iterator it);
+        void evict();
+    };
+}
\ No newline at end of file
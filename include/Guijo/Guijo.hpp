@@ -3,10 +3,29 @@
 #include "Guijo/Window/Window.hpp"
 #include "Guijo/Event/BasicEvents.hpp"
 #include "Guijo/Event/StateLinked.hpp"
+#include "Guijo/Graphics/Font.hpp"
 
 namespace Guijo {
     class Gui {
     public:
+        using Clock = std::chrono::steady_clock;
+
+        enum class Mode {
+            Continuous, // Render every window every loop, never block
+            Events,     // Only render after changes, block until input, tasks or animations
+        };
+
+        struct Statistics {
+            std::size_t frames = 0;  // Window frames rendered
+            std::size_t skipped = 0; // Window frames skipped, nothing changed
+            std::size_t waits = 0;   // Times the loop blocked
+            std::size_t tasks = 0;   // Posted tasks run
+        };
+
+        Mode mode = Mode::Continuous;
+        double frameRate = 0; // Maximum frames per second, 0 for no cap
+        bool vsync = false;   // Pace frames to the display's vertical blank
+
         template<std::derived_from<Window> Ty>
         Pointer<Ty> emplace(const typename Ty::Construct& arg) {
             Ty* _value = new Ty{ arg };
@@ -15,16 +34,94 @@ namespace Guijo {
             return _value;
         }
 
+        // Run a task on the loop's thread after the delay, can be called from
+        // any thread. Wakes the loop when it is waiting.
+        void post(std::function<void()> task, Clock::duration delay = {}) {
+            {
+                std::lock_guard _lock{ m_Mutex };
+                m_Tasks.emplace(Clock::now() + delay, std::move(task));
+            }
+            Window::wake();
+        }
+
         bool loop() {
+            FrameClock::tick(); // Same time for all animations this frame
+            Font::tick();       // And the same frame for glyph page usage
+            if (runTasks()) for (auto& _window : m_Windows) _window->redraw = true;
+
+            bool _rendered = false;
             auto i = m_Windows.begin();
             while (i != m_Windows.end()) {
-                if (!(*i)->loop()) m_Windows.erase(i++);
+                AnimationScheduler::current = &(*i)->animations;
+                const bool _open = (*i)->loop();
+                if (_open && (mode == Mode::Continuous || (*i)->needsFrame())) {
+                    (*i)->render();
+                    _rendered = true;
+                    ++m_Statistics.frames;
+                } else if (_open) ++m_Statistics.skipped;
+                AnimationScheduler::current = nullptr;
+                if (!_open) m_Windows.erase(i++);
                 else ++i;
             }
+
+            if (_rendered) Font::evict(); // Keep glyph memory within budget
+            if (_rendered) m_LastFrame = Clock::now();
+            if (_rendered && vsync) Window::verticalBlank();
+            pace();
             return m_Windows.size() != 0;
         }
 
+        const Statistics& statistics() const { return m_Statistics; }
+        void resetStatistics() { m_Statistics = {}; }
+
     private:
         std::list<Pointer<Window>> m_Windows;
+        std::multimap<Clock::time_point, std::function<void()>> m_Tasks; // By due time
+        std::mutex m_Mutex; // Guards m_Tasks
+        Clock::time_point m_LastFrame{};
+        Statistics m_Statistics{};
+
+        // Run all due tasks, returns whether any ran
+        bool runTasks() {
+            std::vector<std::function<void()>> _due;
+            {
+                std::lock_guard _lock{ m_Mutex };
+                const auto _end = m_Tasks.upper_bound(Clock::now());
+                for (auto _it = m_Tasks.begin(); _it != _end; ++_it)
+                    _due.push_back(std::move(_it->second));
+                m_Tasks.erase(m_Tasks.begin(), _end);
+            }
+            for (auto& _task : _due) _task(); // Unlocked, tasks may post tasks
+            m_Statistics.tasks += _due.size();
+            return !_due.empty();
+        }
+
+        // Block until the next frame is due, or until something needs
+        // handling when no window needs a frame.
+        void pace() {
+            if (m_Windows.empty()) return; // Loop is about to end
+            std::optional<Clock::time_point> _until;
+            const auto _earliest = [&](Clock::time_point time) {
+                if (!_until || time < *_until) _until = time;
+            };
+
+            bool _frame = mode == Mode::Continuous;
+            for (auto& _window : m_Windows) _frame |= _window->needsFrame();
+
+            if (_frame) {
+                if (frameRate <= 0) return; // Uncapped, render right away
+                _earliest(m_LastFrame + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(1. / frameRate)));
+            } else if (mode == Mode::Continuous) return;
+
+            {
+                std::lock_guard _lock{ m_Mutex };
+                if (!m_Tasks.empty()) _earliest(m_Tasks.begin()->first);
+            }
+
+            if (_until && *_until <= Clock::now()) return;
+            ++m_Statistics.waits;
+            Window::wait(_until);
+        }
     };
 }
\ No newline at end of file
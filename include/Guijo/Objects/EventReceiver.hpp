@@ -34,7 +34,7 @@ namespace Guijo {
 
     protected:
         std::vector<State> m_States{};
-        std::vector<Pointer<EventHandler>> m_EventHandlers{};
+        std::vector<std::vector<Pointer<EventHandler>>> m_EventHandlers{}; // By event type
         std::vector<StateListener*> m_StateListeners{};
 
     public: static StateId newState() { return stateCounter++; }
@@ -43,24 +43,30 @@ namespace Guijo {
 
     template<auto Fun> 
     void EventReceiver::event() {
-        m_EventHandlers.push_back(new TypedEventHandler<Fun>{});
+        using Handler = TypedEventHandler<Fun>;
+        // Receivers of another type never get to handle it
+        auto _self = dynamic_cast<typename Handler::self_type*>(this);
+        if (!_self) return;
+        const EventId _type = eventId<typename Handler::event_type>();
+        if (_type >= m_EventHandlers.size()) m_EventHandlers.resize(_type + 1);
+        m_EventHandlers[_type].push_back(new Handler{ *_self });
     }
 
     template<class Obj> 
     void EventReceiver::event() {
-        if constexpr (detail::m_FindMP<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mousePress>{});
-        if constexpr (detail::m_FindMM<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseMove>{});
-        if constexpr (detail::m_FindMD<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseDrag>{});
-        if constexpr (detail::m_FindMC<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseClick>{});
-        if constexpr (detail::m_FindMR<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseRelease>{});
-        if constexpr (detail::m_FindMW<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseWheel>{});
-        if constexpr (detail::m_FindME<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseEnter>{});
-        if constexpr (detail::m_FindMX<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::mouseExit>{});
-        if constexpr (detail::m_FindFC<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::focus>{});
-        if constexpr (detail::m_FindUF<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::unfocus>{});
-        if constexpr (detail::m_FindKP<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::keyPress>{});
-        if constexpr (detail::m_FindKT<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::keyType>{});
-        if constexpr (detail::m_FindKR<Obj>) m_EventHandlers.push_back(new TypedEventHandler<&Obj::keyRelease>{});
+        if constexpr (detail::m_FindMP<Obj>) event<&Obj::mousePress>();
+        if constexpr (detail::m_FindMM<Obj>) event<&Obj::mouseMove>();
+        if constexpr (detail::m_FindMD<Obj>) event<&Obj::mouseDrag>();
+        if constexpr (detail::m_FindMC<Obj>) event<&Obj::mouseClick>();
+        if constexpr (detail::m_FindMR<Obj>) event<&Obj::mouseRelease>();
+        if constexpr (detail::m_FindMW<Obj>) event<&Obj::mouseWheel>();
+        if constexpr (detail::m_FindME<Obj>) event<&Obj::mouseEnter>();
+        if constexpr (detail::m_FindMX<Obj>) event<&Obj::mouseExit>();
+        if constexpr (detail::m_FindFC<Obj>) event<&Obj::focus>();
+        if constexpr (detail::m_FindUF<Obj>) event<&Obj::unfocus>();
+        if constexpr (detail::m_FindKP<Obj>) event<&Obj::keyPress>();
+        if constexpr (detail::m_FindKT<Obj>) event<&Obj::keyType>();
+        if constexpr (detail::m_FindKR<Obj>) event<&Obj::keyRelease>();
     }
 
     template<std::derived_from<StateListener> Ty> 
@@ -1,11 +1,14 @@
 #pragma once
 #include "Guijo/pch.hpp"
+#include <atomic>
 #include "Guijo/Utils/Vec.hpp"
 #include "Guijo/Utils/Animated.hpp"
+#include "Guijo/Utils/Pointer.hpp"
 #include "Guijo/Event/StateLinked.hpp"
 
 namespace Guijo {
     class Object;
+    class VirtualList;
     namespace Flex {
         enum class Direction {
             Row,            // left-right
@@ -71,14 +74,14 @@ namespace Guijo {
             constexpr Value(vw v) : Parent{ v.value }, type(ViewWidth) {}
             constexpr Value(Type t) : Parent{ 0.f }, type(t) {}
             constexpr Value(float v) : Parent{ v }, type(Pixels) {}
-            constexpr Value(const Value& v) = default;
-            constexpr Value(Value&& v) = default;
+            constexpr Value(const Value& v) : Parent(v), type(v.type), enumValue(v.enumValue) {} // Copy isn't owned by a box
+            constexpr Value(Value&& v) : Parent(v), type(v.type), enumValue(v.enumValue) {}
 
             template<class Ty> requires std::is_enum_v<Ty>
-            constexpr Value(Ty val) : enumValue(static_cast<float>(val)), type(Enum) {}
+            constexpr Value(Ty val) : enumValue(static_cast<float>(val)), type(Type::Enum) {}
 
-            constexpr Value& operator=(const Value& v) = default;
-            constexpr Value& operator=(Value&& v) noexcept = default;
+            constexpr Value& operator=(const Value& v) { return copy(v); }
+            constexpr Value& operator=(Value&& v) noexcept { return copy(v); }
             constexpr Value& operator=(px v) { return assign(v.value, Pixels); }
             constexpr Value& operator=(pc v) { return assign(v.value, Percent); }
             constexpr Value& operator=(vh v) { return assign(v.value, ViewHeight); }
@@ -88,11 +91,21 @@ namespace Guijo {
             
             template<class Ty> requires std::is_enum_v<Ty>
             constexpr Value& operator=(Ty val) {
+                if (type == Type::Enum && enumValue == static_cast<float>(val)) return *this;
                 enumValue = static_cast<float>(val);
-                type = Enum;
+                type = Type::Enum;
+                changed();
                 return *this;
             }
 
+            constexpr void jump(float val) { Parent::jump(val), changed(); }
+
+            void update(StateId id, State value) override {
+                const std::size_t _prev = m_Current;
+                Parent::update(id, value);
+                if (m_Current != _prev) changed(); // Only when the linked value changed
+            }
+
             constexpr Type getType() const { return type; }
 
             constexpr bool is(Type t) const { return type == t; }
@@ -100,7 +113,7 @@ namespace Guijo {
 
             template<class Ty> requires std::is_enum_v<Ty>
             constexpr bool operator==(Ty val) const {
-                return static_cast<float>(val) == enumValue && type == Enum;
+                return static_cast<float>(val) == enumValue && type == Type::Enum;
             }
 
             template<class Ty> requires std::is_enum_v<Ty>
@@ -109,14 +122,26 @@ namespace Guijo {
         private:
             Type type;
             float enumValue{};
+            Box* owner = nullptr; // Box this value belongs to, invalidated on change
 
             constexpr Value& assign(float newval, Type newtype) {
-                if (newtype != type) value(newval), type = newtype;
-                else value(newval);
+                if (newtype == type && newval == m_Default) return *this;
+                value(newval), type = newtype;
+                changed();
+                return *this;
+            }
+
+            constexpr Value& copy(const Value& v) {
+                Parent::operator=(v);
+                type = v.type;
+                enumValue = v.enumValue;
+                changed();
                 return *this;
             }
 
-            void classAssign(const Value& v);
+            constexpr void changed() { if (owner) invalidateOwner(); }
+            void invalidateOwner();
+            bool follow(const Value& v, const EventReceiver* states, StateFind changed);
 
             friend class EventReceiver;
             friend class Box;
@@ -130,6 +155,9 @@ namespace Guijo {
             constexpr CalcValue(Value::Type t, float v) : value(v), type(t) {}
             constexpr CalcValue(Value::Type t) : value(0.f), type(t) {}
             constexpr CalcValue(float v) : value(v), type(Pixels) {}
+
+            template<class Ty> requires (std::is_enum_v<Ty> && !std::same_as<Ty, Value::Type>)
+            constexpr CalcValue(Ty val) : value(static_cast<float>(val)), type(Value::Type::Enum) {}
         
             constexpr void operator=(float v) { value = v, type = Pixels; }
             constexpr operator float() const { return value; }
@@ -137,23 +165,33 @@ namespace Guijo {
             constexpr bool is(Value::Type t) const { return type == t; }
             constexpr bool definite() const { return static_cast<std::int8_t>(type) >= 0; }
 
+            template<class Ty> requires std::is_enum_v<Ty>
+            constexpr bool operator==(Ty val) const {
+                return static_cast<float>(val) == value && type == Value::Type::Enum;
+            }
+
+            template<class Ty> requires std::is_enum_v<Ty>
+            constexpr Ty as() const { return static_cast<Ty>(value); }
+
             Value::Type type;
             float value;
 
             CalcValue decode(Box&, CalcValue);
         };
 
-        struct Margin {
-            Value left;
-            Value top;
-            Value right;
-            Value bottom;
+        // Groups of values, of a class or of a box
+        template<class Ty>
+        struct BasicMargin {
+            Ty left;
+            Ty top;
+            Ty right;
+            Ty bottom;
 
             constexpr operator Vec4<float>() const {
                 return { left, top, right, bottom };
             }
 
-            constexpr Margin& operator=(const Vec4<float>& v) {
+            constexpr BasicMargin& operator=(const Vec4<float>& v) {
                 left = v[0];
                 top = v[1];
                 right = v[2];
@@ -161,10 +199,10 @@ namespace Guijo {
                 return *this;
             }
 
-            constexpr Margin& operator=(float v) { return operator=(Vec4<float>{ v, v, v, v }); };
+            constexpr BasicMargin& operator=(float v) { return operator=(Vec4<float>{ v, v, v, v }); };
 
             struct Assigner {
-                Margin& margin;
+                BasicMargin& margin;
                 StateLink state;
                 constexpr void operator=(float v) {
                     margin.left[state] = v;
@@ -180,31 +218,29 @@ namespace Guijo {
             constexpr void curve(Curve curve) { left.curve(curve), top.curve(curve), right.curve(curve), bottom.curve(curve); };
             constexpr void transition(double millis) { left.transition(millis), top.transition(millis), right.transition(millis), bottom.transition(millis); }
             constexpr void jump(float val) { left.jump(val), top.jump(val), right.jump(val), bottom.jump(val); }
-
-        private:
-            CalcValue get(std::size_t i);
-            friend class Box;
         };
+        using Margin = BasicMargin<Value>;
         using Padding = Margin;
 
-        struct Size {
-            Value width;
-            Value height;
+        template<class Ty>
+        struct BasicSize {
+            Ty width;
+            Ty height;
 
             constexpr operator Vec2<float>() const {
                 return { width, height };
             }
 
-            constexpr Size& operator=(const Vec2<float>& v) {
+            constexpr BasicSize& operator=(const Vec2<float>& v) {
                 width = v[0];
                 height = v[1];
                 return *this;
             }
 
-            constexpr Size& operator=(float v) { return operator=(Vec2<float>{ v, v }); };
+            constexpr BasicSize& operator=(float v) { return operator=(Vec2<float>{ v, v }); };
 
             struct Assigner {
-                Size& margin;
+                BasicSize& margin;
                 StateLink state;
                 constexpr void operator=(float v) {
                     margin.width[state] = v;
@@ -218,34 +254,32 @@ namespace Guijo {
             constexpr void curve(Curve curve) { width.curve(curve), height.curve(curve); };
             constexpr void transition(double millis) { width.transition(millis), height.transition(millis); }
             constexpr void jump(float val) { width.jump(val), height.jump(val); }
-
-        private:
-            CalcValue get(std::size_t i);
-            friend class Box;
         };
+        using Size = BasicSize<Value>;
 
-        struct Point {
-            Value x;
-            Value y;
+        template<class Ty>
+        struct BasicPoint {
+            Ty x;
+            Ty y;
 
             constexpr operator Vec2<float>() const {
                 return { x, y };
             }
 
-            constexpr Flex::Point& operator=(const Vec2<float>& v) {
+            constexpr BasicPoint& operator=(const Vec2<float>& v) {
                 x = v[0];
                 y = v[1];
                 return *this;
             }
 
-            constexpr Point& operator=(float v) { return operator=(Vec2<float>{ v, v }); };
-
-        private:
-            CalcValue get(std::size_t i);
-            friend class Box;
+            constexpr BasicPoint& operator=(float v) { return operator=(Vec2<float>{ v, v }); };
         };
+        using Point = BasicPoint<Value>;
 
-        struct Class {
+        // Style shared by any number of boxes. Boxes point to their class
+        // instead of copying it, values set on a box itself win from the class.
+        // Assign a different class to restyle, don't change one that's in use.
+        struct Class : Refcounted {
             Point overflow{ Value::Unset, Value::Unset }; // Overflow
             Size size{ Value::Unset, Value::Unset };      // Prefered size
             Size max{ Value::Unset, Value::Unset };       // Maximum size
@@ -270,37 +304,148 @@ namespace Guijo {
             } align{};
         };
 
-        struct Box {
-            Point overflow{ Value::Auto, Value::Auto }; // Overflow
-            Size size{ Value::Auto, Value::Auto };      // Prefered size
-            Size max{ Value::None, Value::None };       // Maximum size
-            Size min{ Value::None, Value::None };       // Minimum size
-            Margin margin{ 0, 0, 0, 0 };                // Margin
-            Padding padding{ 0, 0, 0, 0 };              // Padding
-            Value position = Static;                    // Item positioning
+        struct LayoutStatistics {
+            std::atomic<std::size_t> layouts = 0; // Layout passes that were calculated
+            std::atomic<std::size_t> hits = 0;    // Layout passes reused from the cache
+            std::atomic<std::size_t> measures = 0; // Objects that measured their content
 
-            struct {
-                Value direction = Row;     // Flex direction
-                Value basis = Value::Auto; // prefered size
-                Value grow = 0;            // Proportion this item can grow relative to other items
-                Value shrink = 1;          // Proportion this item can shrink relative to other items
-                Value wrap = NoWrap;       // Wrapping mode
-            } flex{};
+            void reset() { layouts = 0, hits = 0, measures = 0; }
+        };
+
+        // Resolved layout inputs of all boxes as a structure of arrays, one
+        // contiguous array per field, indexed by a box's node. The solver reads
+        // these instead of the animated, state linked Values, which are only
+        // read again after they change or while they're animating.
+        class NodeStore {
+        public:
+            enum class Field : std::uint8_t { // Same order as Box::fields()
+                OverflowX, OverflowY, Width, Height, MaxWidth, MaxHeight, MinWidth, MinHeight,
+                MarginLeft, MarginTop, MarginRight, MarginBottom,
+                PaddingLeft, PaddingTop, PaddingRight, PaddingBottom,
+                Position, FlexDirection, FlexBasis, FlexGrow, FlexShrink, FlexWrap,
+                Justify, AlignContent, AlignItems, AlignSelf, Amount
+            };
+            constexpr static std::size_t Fields = static_cast<std::size_t>(Field::Amount);
+
+            std::uint32_t allocate();
+            void release(std::uint32_t node);
+
+            constexpr CalcValue* operator[](Field field) { 
+                return m_Fields[static_cast<std::size_t>(field)].data(); 
+            }
+
+        private:
+            std::array<std::vector<CalcValue>, Fields> m_Fields{};
+            std::vector<std::uint32_t> m_Free{}; // Released nodes, reused first
+        };
+
+        // Value of a box. A box only stores the values that are set on it, or
+        // that transition for it, instead of all of them. Setting one overrides
+        // the class, reading gives what the layout uses: the box's own value,
+        // else its class's, else the default.
+        class Property {
+        public:
+            constexpr Property(Box* box, NodeStore::Field field) : box(box), field(field) {}
+            Property(const Property&) = delete;
+            Property& operator=(const Property&) = delete;
+
+            Property& operator=(const Value& v) { return own() = v, *this; }
+            Property& operator=(px v) { return own() = v, *this; }
+            Property& operator=(pc v) { return own() = v, *this; }
+            Property& operator=(vh v) { return own() = v, *this; }
+            Property& operator=(vw v) { return own() = v, *this; }
+            Property& operator=(Value::Type v) { return own() = v, *this; }
+            Property& operator=(float v) { return own() = v, *this; }
+
+            template<class Ty> requires std::is_enum_v<Ty>
+            Property& operator=(Ty val) { return own() = val, *this; }
+
+            float& operator[](StateId id) { return own()[id]; }
+            float& operator[](StateLink link) { return own()[link]; }
+
+            // Also apply to values that follow the class
+            void curve(Curve curve) { animated().curve(curve); }
+            void transition(double millis) { animated().transition(millis); }
+            void jump(float val) { own().jump(val); }
+
+            CalcValue get() const;
+            operator float() const { return get().value; }
+            Value::Type getType() const { return get().type; }
+
+            bool is(Value::Type t) const { return get().is(t); }
+            bool definite() const { return get().definite(); }
+
+            template<class Ty> requires std::is_enum_v<Ty>
+            bool operator==(Ty val) const { return get() == val; }
+
+            template<class Ty> requires std::is_enum_v<Ty>
+            Ty as() const { return get().as<Ty>(); }
+
+        private:
+            Box* box;
+            NodeStore::Field field;
+
+            Value& own();      // Stored on the box, wins from its class
+            Value& animated(); // Stored on the box, still follows its class
+        };
+
+        struct Box : StateListener {
+            BasicPoint<Property> overflow{ { this, Field::OverflowX }, { this, Field::OverflowY } }; // Overflow, Auto
+            BasicSize<Property> size{ { this, Field::Width }, { this, Field::Height } };            // Prefered size, Auto
+            BasicSize<Property> max{ { this, Field::MaxWidth }, { this, Field::MaxHeight } };       // Maximum size, None
+            BasicSize<Property> min{ { this, Field::MinWidth }, { this, Field::MinHeight } };       // Minimum size, None
+            BasicMargin<Property> margin{ { this, Field::MarginLeft }, { this, Field::MarginTop },  // Margin, 0
+                { this, Field::MarginRight }, { this, Field::MarginBottom } };
+            BasicMargin<Property> padding{ { this, Field::PaddingLeft }, { this, Field::PaddingTop }, // Padding, 0
+                { this, Field::PaddingRight }, { this, Field::PaddingBottom } };
+            Property position{ this, Field::Position }; // Item positioning, Static
 
-            Value justify = Start; // Justify content (inline)
             struct {
-                Value content = Stretch;  // Align content (block)
-                Value items = Stretch;    // Align items (Individual Items)
-                Value self = Value::Auto; // Align self
-            } align{};
+                Property direction; // Flex direction, Row
+                Property basis;     // prefered size, Auto
+                Property grow;      // Proportion this item can grow relative to other items, 0
+                Property shrink;    // Proportion this item can shrink relative to other items, 1
+                Property wrap;      // Wrapping mode, NoWrap
+            } flex{ { this, Field::FlexDirection }, { this, Field::FlexBasis }, { this, Field::FlexGrow }, 
+                { this, Field::FlexShrink }, { this, Field::FlexWrap } };
+
+            Property justify{ this, Field::Justify }; // Justify content (inline), Start
+            struct {
+                Property content; // Align content (block), Stretch
+                Property items;   // Align items (Individual Items), Stretch
+                Property self;    // Align self, Auto
+            } align{ { this, Field::AlignContent }, { this, Field::AlignItems }, { this, Field::AlignSelf } };
 
             bool use = true; // Use FlexBox sizing for children
+
+            Box();
+            Box(const Box&) = delete;
+            ~Box();
             
             void format(Object&, bool sizing = false); // Apply FlexBox formatting to Object
 
-            void operator=(const Class&);
+            // Mark this box and its ancestors for layout. Values, child lists and
+            // scrolling do this automatically, call it after changing 'use' or
+            // the size of an object that sizes itself.
+            void invalidate();
+            bool needsLayout() const { return invalidated; }
+
+            // The object's content changed, measure it again and lay out
+            void remeasure();
+
+            void operator=(const Class&);  // Uses a copy of the class, share a Pointer<Class> to not copy
+            void operator=(Pointer<Class>);
 
             static inline Vec2<float> windowSize; // Window size, used with 'vh' and 'vw' units
+            static inline bool cache = true;      // Reuse layout passes with the same constraints
+            static inline LayoutStatistics statistics{};
+            static inline NodeStore store{};
+
+            // Lay out large sibling subtrees on multiple threads, once their parent
+            // has given them their size. Subtrees with fewer boxes than the threshold
+            // stay on the calling thread. Gives the same results as serial layout.
+            static inline bool parallel = false;
+            static inline std::size_t parallelThreshold = 256;
         private:
             Vec2<CalcValue> innerAvailableSize{}; // Available size for items (either infinite or definite)
             Vec2<CalcValue> availableSize{};      // Available size for itself
@@ -311,9 +456,108 @@ namespace Guijo {
             Vec2<CalcValue> targetSize{};         // target size in flex-line
             Vec2<CalcValue> usedSize{};           // definitive size based on flex-line
             Box* parent = nullptr;            // Parent size, used with % unit
-            bool violationType = false;       // Min-max violation when resolving flexible sizes
-            bool freezeSize = false;          // Used when resolving flexible sizes in flex-line
             bool invalidated = true;          // Does this box need to be recalculated?
+            std::size_t nodes = 1;            // Boxes in this subtree, as of its last layout
+            std::uint32_t node;               // Index of our resolved values in the store
+            bool stale = true;                // Values changed since they were resolved
+            bool moving = false;              // Values were animating when they were resolved
+            bool relative = false;            // Any value is a percentage
+            bool hidden = false;              // Not visible, left out of the layout with its subtree
+            Pointer<Class> styleClass{};       // Shared style, for values we don't set ourselves
+            const EventReceiver* receiver = nullptr; // States that select the class's linked values
+            std::vector<std::pair<NodeStore::Field, Value>> values{}; // Values stored on this box
+            std::uint32_t overrides = 0;      // Values set on this box, one bit per field
+            std::uint32_t classed = 0;        // Values that follow the class
+            std::uint32_t classLinked = 0;    // Values the class links to states
+
+            // Everything a layout pass of this box depends on besides its own
+            // values and children, which invalidate the box when they change.
+            struct Input {
+                Vec2<CalcValue> parentSize{}; // Parent's inner available size
+                Vec2<CalcValue> usedSize{};   // Used size given by the parent
+                Vec2<float> windowSize{};
+                Dimensions<float> dimensions{}; // Position and size of the object
+                bool parentUse = false;
+                std::size_t parentDirection = 0;
+                bool use = true;
+                bool scrollbarX = false; // Visible scrollbars take up space
+                bool scrollbarY = false;
+                bool sizing = false;
+
+                bool operator==(const Input&) const;
+            };
+
+            // Results of recent layout passes, keyed on their input. A parent calls
+            // format up to 3 times per pass (sizing, stretched sizing, final), with
+            // this a subtree is only laid out once per distinct constraint instead
+            // of once per call, which grows exponentially with nesting. Only the
+            // last final pass is kept, the items are where that one placed them.
+            struct Memo {
+                bool valid = false;
+                bool transient = false; // Only valid in the pass it was made in (animating)
+                std::size_t pass = 0;
+                Input input{};
+                Vec2<CalcValue> availableSize{};
+                Vec2<CalcValue> innerAvailableSize{};
+                Vec2<CalcValue> usedSize{};
+            };
+            std::array<Memo, 5> memo{};
+            std::uint8_t memoNext = 0; // Entry to replace next
+
+            // Recent results of the object's measure, keyed on the space it got
+            struct Measured {
+                bool valid = false;
+                Vec2<float> space{};
+                std::optional<Vec2<float>> size{};
+            };
+            std::array<Measured, 4> measured{};
+            std::uint8_t measuredNext = 0;
+
+            static inline std::size_t pass = 0; // Increments every root layout
+
+            // Items of a flex line, kept from sizing until they're placed
+            struct Line {
+                std::span<Pointer<Object>> items{};
+                float usedSpace = 0;
+                float flexGrow = 0;
+                float flexShrink = 0;
+                float crossSize = 0;
+            };
+            std::vector<Line> lines{};
+            std::vector<Pointer<Object>> shown{}; // Visible items, when some are hidden
+
+            // Box that has been sized, but its items still need to be placed
+            struct Deferred {
+                Object* object;
+                Input input;
+                bool animating;
+            };
+
+            void format(Object&, bool sizing, std::vector<Deferred>* deferred);
+            std::vector<Pointer<Object>>& items(Object&); // Items that aren't hidden
+            void finish(Object&, const Input&, bool animating);
+            Input input(Object&, bool sizing);
+            bool restore(const Input&); // Restore results from the cache, if there are any
+            template<class Items> void formatItems(Items&, bool sizing);
+            bool layout(Object&); // Size this box, returns whether its items need placing
+            void resolveFlexibleLengths(Line&, std::size_t main, float available);
+            std::optional<Vec2<float>> measure(Object&, Vec2<CalcValue> available); // Content size plus padding
+            void place(Object&);
+            void dirty(); // Only mark for next frame, keeps this frame's results
+            template<class Style> static auto fields(Style&); // Values of a class, in store order
+
+            using Field = NodeStore::Field;
+            Value* find(Field); // Our value, if it's stored
+            const Value* find(Field) const;
+            Value& emplace(Field);  // Our value, stored with the default if it isn't yet
+            Value& override(Field); // Our value, which then wins from the class
+            CalcValue current(Field) const; // Our value, the class's, or the default
+            void resolve(); // Refresh our values in the store, if they could have changed
+            void update(StateId id, State value) override;
+            void restyle(StateFind changed = { static_cast<StateId>(-1) }); // Follow the class for our states
+            constexpr CalcValue style(Field field, std::size_t offset = 0) const {
+                return store[static_cast<Field>(static_cast<std::size_t>(field) + offset)][node];
+            }
             
             void calcAvailableSize();
             std::size_t flowDirection();
@@ -322,6 +566,10 @@ namespace Guijo {
             CalcValue subPadding(CalcValue, std::size_t, CalcValue);
             CalcValue subMargin(CalcValue, std::size_t, CalcValue);
             friend class CalcValue;
+            friend class Value;
+            friend class Property;
+            friend class Guijo::Object;
+            friend class Guijo::VirtualList;
             friend class Window;
         };
     }
@@ -0,0 +1,80 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include "Guijo/Utils/Pointer.hpp"
+#include "Guijo/Utils/Vec.hpp"
+
+namespace Guijo {
+    class Object;
+
+    // Bounding volume hierarchy over the laid out objects of a scope: the
+    // visible descendants of a root or scroll container, in its content's
+    // coordinates, clipped by the objects between. Scroll containers are in
+    // the index of their scope, their descendants in an index of their own,
+    // so scrolling them moves nothing. Objects are numbered in drawing order,
+    // descendants follow their ancestor, so a subtree is a range of numbers.
+    // The layout marks the index dirty when it places items, it's rebuilt
+    // on the next event.
+    class HitIndex : public Refcounted {
+    public:
+        HitIndex(Object& root) : m_Root(&root) {}
+
+        void invalidate() { m_Dirty = true; }
+        void detach() { m_Root = nullptr; } // Root is destroyed
+        void update(); // Rebuild when invalidated
+
+        // Whether the index is up to date and contains the object at 'order'
+        bool ready(const Object& object, std::uint32_t order) const;
+
+        // Whether any descendant of the object at 'order' is hit by the
+        // position, in the coordinates of the root's content. Objects under
+        // the cursor are found in logarithmic time and cached for the next
+        // call. Their hitbox, and those of their ancestors up to the object,
+        // decide whether they're hit, like hit testing recursively would.
+        bool hit(Point<float> pos, std::uint32_t order) const;
+
+    private:
+        struct Bounds {
+            float x1, y1, x2, y2;
+
+            bool contains(Point<float> pos) const {
+                return pos.x() >= x1 && pos.x() <= x2 && pos.y() >= y1 && pos.y() <= y2;
+            }
+
+            bool empty() const { return x1 > x2 || y1 > y2; }
+        };
+
+        struct Entry {
+            Bounds bounds;        // Visible part, in the root's content coordinates
+            Point<float> offset;  // Scroll between root and the object's parent
+            Object* object;
+            std::uint32_t parent; // Number of the parent, NoParent for the root's children
+            std::uint32_t last;   // One past the number of the last descendant
+        };
+
+        struct Node {
+            Bounds bounds;            // Of the entries below
+            std::uint32_t first = 0;  // Entries in m_Order for leaves, else the left child
+            std::uint32_t count = 0;  // Entries in a leaf, 0 for other nodes
+        };
+
+        constexpr static std::uint32_t LeafSize = 4;
+        constexpr static std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+
+        Object* m_Root;
+        std::atomic<bool> m_Dirty = true; // Layouts on multiple threads can invalidate
+        std::vector<Entry> m_Entries{};   // In drawing order
+        std::vector<std::uint32_t> m_Order{}; // Visible entries sorted into the leaves
+        std::vector<Node> m_Nodes{};
+
+        mutable std::uint32_t m_Query = 0;             // Increments every query, 0 is none
+        mutable Point<float> m_Position{};             // Position of the last query
+        mutable std::vector<std::uint32_t> m_Under{};  // Entries under that position, sorted
+        mutable std::vector<std::uint32_t> m_Tested{}; // Query an entry's hitbox was called in
+        mutable std::vector<bool> m_Hitbox{};          // And what it returned
+
+        void add(Object&, Point<float> offset, Bounds clip, std::uint32_t parent);
+        void build(std::uint32_t node, std::uint32_t first, std::uint32_t count);
+        void query(Point<float>) const;
+        bool hitbox(std::uint32_t entry, Point<float>) const;
+    };
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Guijo/Objects/Flex.hpp"
 #include "Guijo/Objects/EventReceiver.hpp"
 #include "Guijo/Objects/Scrollbar.hpp"
+#include "Guijo/Objects/HitIndex.hpp"
 
 namespace Guijo {
 
@@ -17,7 +18,7 @@ namespace Guijo {
         } scrollbar;
 
         Object();
-        virtual ~Object() = default;
+        virtual ~Object();
 
         virtual bool hitbox(Point<float> pos) const override;
         virtual void handle(const Event& e) override;
@@ -28,9 +29,23 @@ namespace Guijo {
 
         virtual void update();
 
+        // Children are laid out as if nothing is scrolled, drawing and hit
+        // testing move them by this instead, so scrolling needs no layout.
+        Point<float> scrolled() const;
+
+        // Size of the object's own content, like text, in the space it gets.
+        // Called by the layout for Auto sizes, results are kept per space
+        // until 'box.remeasure()'. Objects without content return nothing.
+        virtual std::optional<Size<float>> measure(Size<float>) const { return {}; }
+
         virtual std::vector<Pointer<Object>>& objects() { return m_Objects; };
         virtual std::vector<Pointer<Object>> const& objects() const { return m_Objects; };
 
+        // Children as they were laid out, these are drawn, hit tested and get
+        // events. Differs from objects() for children that wait for a layout.
+        virtual std::vector<Pointer<Object>>& laid() { return m_Objects; }
+        virtual std::vector<Pointer<Object>> const& laid() const { return m_Objects; }
+
         template<std::derived_from<Object> Ty, class ...Args>
         Pointer<Ty> emplace(Args&&...args);
 
@@ -40,10 +55,27 @@ namespace Guijo {
         template<auto Fun> void state(std::size_t state);
 
     private:
-        std::vector<Pointer<StateHandler>> m_StateHandlers{};
+        std::vector<std::vector<Pointer<StateHandler>>> m_StateHandlers{}; // By event type
         std::vector<Pointer<Object>> m_Objects{};
 
+        // Where we are in the hit index of our scope, and the index of our
+        // children when we're the root of a scope ourselves.
+        struct {
+            Pointer<HitIndex> scope{};
+            std::uint32_t order = 0; // Our number in the scope
+            Point<float> offset{};   // Scroll between the scope's root and our parent
+            bool root = false;       // Whether we were the root of a scope back then
+        } m_Hit;
+        Pointer<HitIndex> m_Hits{};
+
+        bool clipping() const;  // Hitbox is only our own dimensions
+        bool scrolling() const; // Clips and can scroll, so it's the root of a scope
+        void placed();          // Called by the layout after placing our children
+
         void mouseWheel(const MouseWheel&);
+
+        friend class HitIndex;
+        friend class Flex::Box;
     };
 
     template<std::derived_from<Object> Ty, class ...Args>
@@ -51,16 +83,23 @@ namespace Guijo {
         Ty* _value = new Ty{ std::forward<Args>(args)... };
         objects().push_back(dynamic_cast<Object*>(_value));
         _value->remember();
+        box.invalidate();
         return _value;
     }
 
     template<std::derived_from<Object> Ty>
     void Object::push(Pointer<Ty> object) {
         objects().push_back(object);
+        box.invalidate();
     }
 
     template<auto Fun>
     void Object::state(std::size_t state) {
-        m_StateHandlers.push_back(new TypedStateHandler<Fun>{ state });
+        using Handler = TypedStateHandler<Fun>;
+        auto _self = dynamic_cast<typename Handler::self_type*>(this);
+        if (!_self) return;
+        const EventId _type = eventId<typename Handler::event_type>();
+        if (_type >= m_StateHandlers.size()) m_StateHandlers.resize(_type + 1);
+        m_StateHandlers[_type].push_back(new Handler{ state, *_self });
     }
-}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include "Guijo/Objects/Object.hpp"
+#include "Guijo/Utils/PrefixSums.hpp"
+
+namespace Guijo {
+    // Vertically scrolling list that only creates, lays out, draws and
+    // forwards events to the rows in view, plus an overscan above and below.
+    // Rows are created on demand and measured once laid out, rows that
+    // haven't been laid out yet count as 'estimate' high. Two spacers take
+    // the place of the rows that aren't materialized, so the scroll range
+    // covers the entire list. Rows are stacked from the top, keep the
+    // default justify and wrapping. Rows are picked in update(), from the
+    // height and scroll of the last layout, never during layout itself,
+    // which may run on other threads. Rows picked there are laid out the
+    // next frame, until then laid() keeps the rows of the last layout, so
+    // those are drawn, hit tested and get events.
+    class VirtualList : public Object {
+    public:
+        using Factory = std::function<Pointer<Object>(std::size_t)>;
+
+        VirtualList(std::size_t count, Factory create, float estimate = 20);
+        ~VirtualList();
+
+        float estimate;       // Height of rows that haven't been measured
+        float overscan = 200; // Height above and below the view that is materialized too
+
+        std::size_t count() const { return m_Heights.size(); }
+        void count(std::size_t count); // Change the amount of rows, forgets all measurements
+        void refresh();                // Create the materialized rows again
+
+        std::size_t first() const { return m_First; } // First materialized row
+        std::size_t last() const { return m_Last; }   // One past the last materialized row
+
+        std::vector<Pointer<Object>>& objects() override { return m_Objects; }
+        std::vector<Pointer<Object>> const& objects() const override { return m_Objects; }
+
+        // Rows of the last layout, until the rows picked since are laid out
+        std::vector<Pointer<Object>>& laid() override { return m_Laid; }
+        std::vector<Pointer<Object>> const& laid() const override { return m_Laid; }
+
+        void update() override;
+
+    private:
+        Factory m_Create;
+        PrefixSums m_Heights{};   // Measured or estimated height of every row
+        std::size_t m_First = 0;
+        std::size_t m_Last = 0;
+        float m_View = 0; // Height of the view at the last layout
+        Pointer<Object> m_Before = new Object{}; // Spacer for the rows above
+        Pointer<Object> m_After = new Object{};  // Spacer for the rows below
+        std::vector<Pointer<Object>> m_Objects{}; // Before, materialized rows, after
+        std::vector<Pointer<Object>> m_Laid{};    // Objects at the last layout
+
+        Object& row(std::size_t index) { return *m_Objects[index - m_First + 1]; }
+        void release(std::size_t first, std::size_t last); // Rows no longer in view
+        std::pair<std::size_t, std::size_t> visible() const; // Rows to materialize at the current scroll
+        bool materialize(); // Pick the visible rows, whether they changed
+    };
+}
\ No newline at end of file
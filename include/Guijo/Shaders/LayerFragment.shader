@@ -0,0 +1,11 @@
+LOAD_AS_STRING(
+out vec4 fragColor;
+
+uniform sampler2D layer;
+
+in vec2 texturePosition;
+
+void main() {
+    fragColor = texture(layer, texturePosition); // Premultiplied colors
+}
+)
\ No newline at end of file
@@ -0,0 +1,12 @@
+LOAD_AS_STRING(
+layout(location = 0) in vec2 aPos;
+
+uniform mat4 mvp;
+
+out vec2 texturePosition;
+
+void main() {
+    gl_Position = mvp * vec4(aPos.x, aPos.y, 0.0, 1.0);
+    texturePosition = aPos; // Layer covers the entire quad
+}
+)
\ No newline at end of file
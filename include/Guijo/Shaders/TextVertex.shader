@@ -1,9 +1,17 @@
 LOAD_AS_STRING(
 layout(location = 0) in vec2 aPos;
-uniform vec4 dim;
+layout(location = 1) in vec4 aGlyph;
+uniform vec2 origin;
+uniform vec2 translate;
+uniform vec4 projection;
+uniform vec2 size;
+uniform float scale;
 out vec2 texturePosition;
+flat out float layer;
 void main() {
-    gl_Position = vec4(dim.x + aPos.x * dim.z, dim.y + aPos.y * dim.w, 0.0, 1.0);
+    vec2 _pos = floor(origin + vec2(aGlyph.x * scale + aGlyph.w, aGlyph.y)) + translate + aPos * size;
+    gl_Position = vec4(_pos * projection.xy + projection.zw, 0.0, 1.0);
     texturePosition = vec2(aPos.x, 1 - aPos.y);
+    layer = aGlyph.z;
 }
 )
\ No newline at end of file
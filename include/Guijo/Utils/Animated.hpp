@@ -1,5 +1,6 @@
 #pragma once
 #include "Guijo/pch.hpp"
+#include <optional>
 
 namespace Guijo {
 
@@ -76,6 +77,58 @@ namespace Guijo {
 		};
 	}
 
+	// Time every Animated samples. Gui ticks it once per loop iteration, so
+	// the clock is queried once per frame and all values within a frame are
+	// read at the same time. Replace the source, or set the time, for
+	// deterministic tests and benchmarks.
+	class FrameClock {
+	public:
+		using Clock = std::chrono::steady_clock;
+		using Source = Clock::time_point(*)();
+
+		static inline Source source = &Clock::now;
+
+		static void tick() { m_Now = source(); } // Sample the source for a new frame
+		static void set(Clock::time_point time) { m_Now = time; }
+		static Clock::time_point now() { return m_Now; }
+
+	private:
+		static inline Clock::time_point m_Now = Clock::now();
+	};
+
+	// End times of running transitions, so a loop knows whether anything is
+	// animating, and until when, without polling every value. Transitions
+	// register when they start and are gone once they reach their goal.
+	class AnimationScheduler {
+	public:
+		using TimePoint = FrameClock::Clock::time_point;
+
+		// Scheduler of the window being handled, transitions started
+		// outside of any window register with the global scheduler.
+		static inline AnimationScheduler* current = nullptr;
+		static AnimationScheduler& global() { static AnimationScheduler _global; return _global; }
+		static AnimationScheduler& active() { return current ? *current : global(); }
+
+		void add(TimePoint end) { m_Ends.push(end); }
+
+		bool animating() { return expire(), !m_Ends.empty(); }
+		std::size_t count() { return expire(), m_Ends.size(); }
+
+		// First time a running transition reaches its goal
+		std::optional<TimePoint> deadline() {
+			expire();
+			if (m_Ends.empty()) return {};
+			return m_Ends.top();
+		}
+
+	private:
+		std::priority_queue<TimePoint, std::vector<TimePoint>, std::greater<>> m_Ends;
+
+		void expire() {
+			while (!m_Ends.empty() && m_Ends.top() <= FrameClock::now()) m_Ends.pop();
+		}
+	};
+
 	template<class Ty>
 	class Animated {
 	public:
@@ -95,7 +148,9 @@ namespace Guijo {
 		constexpr Animated& assign(const Ty& newval) {
 			m_Value = get();
 			m_Goal = newval;
-			m_ChangeTime = std::chrono::steady_clock::now();
+			m_ChangeTime = FrameClock::now();
+			if (m_Time != 0 && m_Value != m_Goal) AnimationScheduler::active().add(m_ChangeTime
+				+ std::chrono::duration_cast<FrameClock::Clock::duration>(std::chrono::duration<double, std::milli>(m_Time)));
 			return *this;
 		}
 
@@ -110,13 +165,20 @@ namespace Guijo {
 			if (m_Time == 0 || m_Value == m_Goal) return m_Goal;
 			const double _percent = std::clamp(
 				std::chrono::duration_cast<std::chrono::milliseconds>(
-					std::chrono::steady_clock::now() - m_ChangeTime)
+					FrameClock::now() - m_ChangeTime)
 				.count() / m_Time, 0., 1.);
 			return m_Value + (m_Goal - m_Value) * m_Curve(_percent);
 		}
 
 		constexpr operator Ty() const { return get(); }
 
+		// Still moving towards the goal
+		constexpr bool animating() const {
+			if (m_Time == 0 || m_Value == m_Goal) return false;
+			return std::chrono::duration_cast<std::chrono::milliseconds>(
+				FrameClock::now() - m_ChangeTime).count() < m_Time;
+		}
+
 	protected:
 		double m_Time = 0;
 		Ty m_Goal{};
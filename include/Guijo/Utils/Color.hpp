@@ -7,6 +7,104 @@ namespace Guijo {
     template<class Ty> class HSV;
     template<class Ty> class HSL;
 
+    // Conversions are defined after the classes, they use them as complete types
+    namespace detail {
+        template<class Ty> constexpr HSV<Ty> rgb2hsv(const RGB<Ty>&);
+        template<class Ty> constexpr RGB<Ty> hsv2rgb(const HSV<Ty>&);
+        template<class Ty> constexpr HSL<Ty> rgb2hsl(const RGB<Ty>&);
+        template<class Ty> constexpr RGB<Ty> hsl2rgb(const HSL<Ty>&);
+        template<class Ty> constexpr HSV<Ty> hsl2hsv(const HSL<Ty>&);
+        template<class Ty> constexpr HSL<Ty> hsv2hsl(const HSV<Ty>&);
+    }
+
+    template<class Ty>
+    class HSV : public VecBase<HSV<Ty>, 4, Ty> { 
+        using Parent = VecBase<HSV<Ty>, 4, Ty>;
+    public:
+        constexpr HSV() : Parent{ {} } {}
+        constexpr HSV(const Ty& h, const Ty& s, const Ty& v, const Ty& a) : Parent{ h, s, v, a } {}
+        constexpr HSV(const Ty& h, const Ty& s, const Ty& v) : Parent{ h, s, v, 255 } {}
+        constexpr HSV(const RGB<Ty>& c) : Parent{ detail::rgb2hsv(c) } {}
+        constexpr HSV(const HSL<Ty>& c) : Parent{ detail::hsl2hsv(c) } {}
+
+        constexpr Ty h() const { return this->template get<0>(); }
+        constexpr Ty s() const { return this->template get<1>(); }
+        constexpr Ty v() const { return this->template get<2>(); }
+        constexpr Ty a() const { return this->template get<3>(); }
+
+        constexpr operator Vec4<Ty>() const { return { h(), s(), v(), a() }; }
+        constexpr RGB<Ty> rgb() const { return *this; }
+        constexpr HSL<Ty> hsl() const { return *this; }
+
+        constexpr void h(const Ty& v) { this->template get<0>() = v; }
+        constexpr void s(const Ty& v) { this->template get<1>() = v; }
+        constexpr void v(const Ty& v) { this->template get<2>() = v; }
+        constexpr void a(const Ty& v) { this->template get<3>() = v; }
+    };
+
+    template<class Ty>
+    class HSL : public VecBase<HSL<Ty>, 4, Ty> {
+        using Parent = VecBase<HSL<Ty>, 4, Ty>;
+    public:
+        constexpr HSL() : Parent{ {} } {}
+        constexpr HSL(const Ty& h, const Ty& s, const Ty& v, const Ty& a) : Parent{ h, s, v, a } {}
+        constexpr HSL(const Ty& h, const Ty& s, const Ty& v) : Parent{ h, s, v, 255 } {}
+        constexpr HSL(const RGB<Ty>& c) : Parent{ detail::rgb2hsl(c) } {}
+        constexpr HSL(const HSV<Ty>& c) : Parent{ detail::hsv2hsl(c) } {}
+
+        constexpr Ty h() const { return this->template get<0>(); }
+        constexpr Ty s() const { return this->template get<1>(); }
+        constexpr Ty l() const { return this->template get<2>(); }
+        constexpr Ty a() const { return this->template get<3>(); }
+
+        constexpr operator Vec4<Ty>() const { return { h(), s(), l(), a() }; }
+        constexpr RGB<Ty> rgb() const { return *this; }
+        constexpr HSV<Ty> hsv() const { return *this; }
+
+        constexpr void h(const Ty& v) { this->template get<0>() = v; }
+        constexpr void s(const Ty& v) { this->template get<1>() = v; }
+        constexpr void l(const Ty& v) { this->template get<2>() = v; }
+        constexpr void a(const Ty& v) { this->template get<3>() = v; }
+    };
+
+    template<class Ty>
+    class RGB : public VecBase<RGB<Ty>, 4, Ty> {
+        using Parent = VecBase<RGB<Ty>, 4, Ty>;
+    public:
+        constexpr RGB() : Parent{ {} } {}
+        constexpr RGB(const Ty& h, const Ty& s, const Ty& v, const Ty& a) : Parent{ h, s, v, a } {}
+        constexpr RGB(const Ty& h, const Ty& s, const Ty& v) : Parent{ h, s, v, 255 } {}
+        constexpr RGB(const Ty& g, const Ty& a) : Parent{ g, g, g, a } {}
+        constexpr RGB(const Ty& g) : Parent{ g, g, g, 255 } {}
+        constexpr RGB(const HSV<Ty>& v) { *this = detail::hsv2rgb(v); }
+        constexpr RGB(const HSL<Ty>& v) { *this = detail::hsl2rgb(v); }
+        constexpr RGB(int hex) : Parent{
+            static_cast<Ty>((hex & 0x00FF0000) >> 16),
+            static_cast<Ty>((hex & 0x0000FF00) >> 8),
+            static_cast<Ty>(hex & 0x000000FF), 
+            static_cast<Ty>(255) } {}
+
+        constexpr Ty r() const { return this->template get<0>(); }
+        constexpr Ty g() const { return this->template get<1>(); }
+        constexpr Ty b() const { return this->template get<2>(); }
+        constexpr Ty a() const { return this->template get<3>(); }
+
+        constexpr operator Vec4<Ty>() const { return { r(), g(), b(), a() }; }
+        constexpr HSV<Ty> hsv() const { return *this; }
+        constexpr HSL<Ty> hsl() const { return *this; }
+
+        constexpr void r(const Ty& v) { this->template get<0>() = v; }
+        constexpr void g(const Ty& v) { this->template get<1>() = v; }
+        constexpr void b(const Ty& v) { this->template get<2>() = v; }
+        constexpr void a(const Ty& v) { this->template get<3>() = v; }
+
+        constexpr RGB brighter(float percent) const {
+            HSL<Ty> _hsv = *this;
+            _hsv.l(std::clamp(_hsv.l() * percent, 0.f, 255.f));
+            return _hsv;
+        }
+    };
+
     namespace detail {
         template<class Ty>
         constexpr HSV<Ty> rgb2hsv(const RGB<Ty>& rgb) {
@@ -234,94 +332,6 @@ namespace Guijo {
         }
     }
 
-    template<class Ty>
-    class HSV : public VecBase<HSV<Ty>, 4, Ty> { 
-        using Parent = VecBase<HSV<Ty>, 4, Ty>;
-    public:
-        constexpr HSV() : Parent{ {} } {}
-        constexpr HSV(const Ty& h, const Ty& s, const Ty& v, const Ty& a) : Parent{ h, s, v, a } {}
-        constexpr HSV(const Ty& h, const Ty& s, const Ty& v) : Parent{ h, s, v, 255 } {}
-        constexpr HSV(const RGB<Ty>& c) : Parent{ detail::rgb2hsv(c) } {}
-        constexpr HSV(const HSL<Ty>& c) : Parent{ detail::hsl2hsv(c) } {}
-
-        constexpr Ty h() const { return this->get<0>(); }
-        constexpr Ty s() const { return this->get<1>(); }
-        constexpr Ty v() const { return this->get<2>(); }
-        constexpr Ty a() const { return this->get<3>(); }
-
-        constexpr operator Vec4<Ty>() const { return { h(), s(), v(), a() }; }
-        constexpr RGB<Ty> rgb() const { return *this; }
-        constexpr HSL<Ty> hsl() const { return *this; }
-
-        constexpr void h(const Ty& v) { this->get<0>() = v; }
-        constexpr void s(const Ty& v) { this->get<1>() = v; }
-        constexpr void v(const Ty& v) { this->get<2>() = v; }
-        constexpr void a(const Ty& v) { this->get<3>() = v; }
-    };
-
-    template<class Ty>
-    class HSL : public VecBase<HSL<Ty>, 4, Ty> {
-        using Parent = VecBase<HSL<Ty>, 4, Ty>;
-    public:
-        constexpr HSL() : Parent{ {} } {}
-        constexpr HSL(const Ty& h, const Ty& s, const Ty& v, const Ty& a) : Parent{ h, s, v, a } {}
-        constexpr HSL(const Ty& h, const Ty& s, const Ty& v) : Parent{ h, s, v, 255 } {}
-        constexpr HSL(const RGB<Ty>& c) : Parent{ detail::rgb2hsl(c) } {}
-        constexpr HSL(const HSV<Ty>& c) : Parent{ detail::hsv2hsl(c) } {}
-
-        constexpr Ty h() const { return this->get<0>(); }
-        constexpr Ty s() const { return this->get<1>(); }
-        constexpr Ty l() const { return this->get<2>(); }
-        constexpr Ty a() const { return this->get<3>(); }
-
-        constexpr operator Vec4<Ty>() const { return { h(), s(), l(), a() }; }
-        constexpr RGB<Ty> rgb() const { return *this; }
-        constexpr HSV<Ty> hsv() const { return *this; }
-
-        constexpr void h(const Ty& v) { this->get<0>() = v; }
-        constexpr void s(const Ty& v) { this->get<1>() = v; }
-        constexpr void l(const Ty& v) { this->get<2>() = v; }
-        constexpr void a(const Ty& v) { this->get<3>() = v; }
-    };
-
-    template<class Ty>
-    class RGB : public VecBase<RGB<Ty>, 4, Ty> {
-        using Parent = VecBase<RGB<Ty>, 4, Ty>;
-    public:
-        constexpr RGB() : Parent{ {} } {}
-        constexpr RGB(const Ty& h, const Ty& s, const Ty& v, const Ty& a) : Parent{ h, s, v, a } {}
-        constexpr RGB(const Ty& h, const Ty& s, const Ty& v) : Parent{ h, s, v, 255 } {}
-        constexpr RGB(const Ty& g, const Ty& a) : Parent{ g, g, g, a } {}
-        constexpr RGB(const Ty& g) : Parent{ g, g, g, 255 } {}
-        constexpr RGB(const HSV<Ty>& v) { *this = detail::hsv2rgb(v); }
-        constexpr RGB(const HSL<Ty>& v) { *this = detail::hsl2rgb(v); }
-        constexpr RGB(int hex) : Parent{
-            static_cast<Ty>((hex & 0x00FF0000) >> 16),
-            static_cast<Ty>((hex & 0x0000FF00) >> 8),
-            static_cast<Ty>(hex & 0x000000FF), 
-            static_cast<Ty>(255) } {}
-
-        constexpr Ty r() const { return this->get<0>(); }
-        constexpr Ty g() const { return this->get<1>(); }
-        constexpr Ty b() const { return this->get<2>(); }
-        constexpr Ty a() const { return this->get<3>(); }
-
-        constexpr operator Vec4<Ty>() const { return { r(), g(), b(), a() }; }
-        constexpr HSV<Ty> hsv() const { return *this; }
-        constexpr HSL<Ty> hsl() const { return *this; }
-
-        constexpr void r(const Ty& v) { this->get<0>() = v; }
-        constexpr void g(const Ty& v) { this->get<1>() = v; }
-        constexpr void b(const Ty& v) { this->get<2>() = v; }
-        constexpr void a(const Ty& v) { this->get<3>() = v; }
-
-        constexpr RGB brighter(float percent) const {
-            HSL<Ty> _hsv = *this;
-            _hsv.l(std::clamp(_hsv.l() * percent, 0.f, 255.f));
-            return _hsv;
-        }
-    };
-
     using Color = RGB<float>;
 }
 
@@ -4,6 +4,9 @@
 namespace Guijo {
     struct Refcounted {
         std::size_t ref = 1;
+        constexpr Refcounted() = default;
+        constexpr Refcounted(const Refcounted&) {} // A copy is a new object, with its own count
+        constexpr Refcounted& operator=(const Refcounted&) { return *this; }
         constexpr virtual ~Refcounted() {};
         constexpr void remember() { ++ref; }
         constexpr void forget() { if (--ref == 0) delete this; }
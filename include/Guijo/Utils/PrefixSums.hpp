@@ -0,0 +1,61 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include <bit>
+
+namespace Guijo {
+    // Sequence of values that keeps its prefix sums (Fenwick tree), so
+    // changing a value, summing a prefix and finding the value containing
+    // an offset all take logarithmic time.
+    class PrefixSums {
+    public:
+        PrefixSums() = default;
+        PrefixSums(std::size_t count, double value = 0) { assign(count, value); }
+
+        void assign(std::size_t count, double value) {
+            m_Values.assign(count, value);
+            m_Tree.assign(count + 1, 0);
+            for (std::size_t _i = 1; _i <= count; ++_i) { // Build in linear time
+                m_Tree[_i] += value;
+                const std::size_t _parent = _i + lowbit(_i);
+                if (_parent <= count) m_Tree[_parent] += m_Tree[_i];
+            }
+        }
+
+        std::size_t size() const { return m_Values.size(); }
+        double operator[](std::size_t i) const { return m_Values[i]; }
+
+        void set(std::size_t i, double value) {
+            const double _delta = value - m_Values[i];
+            m_Values[i] = value;
+            for (std::size_t _j = i + 1; _j < m_Tree.size(); _j += lowbit(_j)) m_Tree[_j] += _delta;
+        }
+
+        // Sum of the first 'count' values
+        double sum(std::size_t count) const {
+            double _sum = 0;
+            for (std::size_t _j = count; _j > 0; _j -= lowbit(_j)) _sum += m_Tree[_j];
+            return _sum;
+        }
+
+        double total() const { return sum(size()); }
+
+        // Index of the value containing the offset when all values are laid
+        // out end to end, size() when the offset is past the end.
+        std::size_t find(double offset) const {
+            std::size_t _index = 0;
+            for (std::size_t _step = std::bit_floor(m_Tree.size()); _step > 0; _step >>= 1) {
+                if (_index + _step < m_Tree.size() && m_Tree[_index + _step] <= offset) {
+                    _index += _step;
+                    offset -= m_Tree[_index];
+                }
+            }
+            return _index;
+        }
+
+    private:
+        std::vector<double> m_Values{};
+        std::vector<double> m_Tree{}; // 1-based, node i sums the lowbit(i) values up to i
+
+        constexpr static std::size_t lowbit(std::size_t i) { return i & (~i + 1); }
+    };
+}
\ No newline at end of file
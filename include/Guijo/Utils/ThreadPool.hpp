@@ -0,0 +1,128 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+
+namespace Guijo {
+    // Work-stealing thread pool. Every worker has its own queue, tasks are
+    // pushed to the queue of the thread that spawns them and idle workers
+    // steal from the other end of other queues. Threads waiting for their
+    // tasks run queued tasks instead of blocking, so tasks can spawn and
+    // wait for tasks of their own without deadlocking.
+    class ThreadPool {
+    public:
+        ThreadPool(std::size_t threads = std::max(std::thread::hardware_concurrency(), 2u) - 1) {
+            for (std::size_t _i = 0; _i < threads + 1; ++_i) // Last queue is for outside threads
+                m_Queues.push_back(std::make_unique<Queue>());
+            for (std::size_t _i = 0; _i < threads; ++_i)
+                m_Workers.emplace_back([this, _i] { work(_i); });
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard _lock{ m_Mutex };
+                m_Stop = true;
+            }
+            m_Wake.notify_all();
+            for (auto& _worker : m_Workers) _worker.join();
+        }
+
+        std::size_t threads() const { return m_Workers.size(); }
+
+        // Call 'fun(i)' for every i in [0, count), the calling thread helps
+        // and this returns once all calls have finished.
+        template<class Fun>
+        void run(std::size_t count, Fun&& fun) {
+            if (count == 0) return;
+            std::atomic<std::size_t> _remaining = count;
+            constexpr auto _call = [](void* fun, std::size_t i) {
+                (*static_cast<std::remove_reference_t<Fun>*>(fun))(i);
+            };
+
+            {   // Count before queueing, a task may be taken before we're done
+                std::lock_guard _lock{ m_Mutex };
+                m_Pending += count;
+            }
+            auto& _queue = *m_Queues[index()];
+            {
+                std::lock_guard _lock{ _queue.mutex };
+                for (std::size_t _i = 0; _i < count; ++_i)
+                    _queue.tasks.push_back({ _call, &fun, _i, &_remaining });
+            }
+            m_Wake.notify_all();
+
+            while (_remaining.load(std::memory_order_acquire) != 0) {
+                if (auto _task = pop(index())) execute(*_task);
+                else std::this_thread::yield(); // Last tasks are running elsewhere
+            }
+        }
+
+    private:
+        struct Task {
+            void(*call)(void*, std::size_t);
+            void* fun;
+            std::size_t index;
+            std::atomic<std::size_t>* remaining;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> m_Queues;
+        std::vector<std::thread> m_Workers;
+        std::mutex m_Mutex;
+        std::condition_variable m_Wake;
+        std::size_t m_Pending = 0; // Queued tasks, workers sleep while 0
+        bool m_Stop = false;
+
+        // Queue of the current thread, as worker of the current pool
+        static inline thread_local ThreadPool* t_Pool = nullptr;
+        static inline thread_local std::size_t t_Index = 0;
+
+        std::size_t index() const { return t_Pool == this ? t_Index : m_Workers.size(); }
+
+        std::optional<Task> pop(std::size_t index) {
+            const auto _take = [&](Queue& queue, bool back) -> std::optional<Task> {
+                std::lock_guard _lock{ queue.mutex };
+                if (queue.tasks.empty()) return {};
+                Task _task = back ? queue.tasks.back() : queue.tasks.front();
+                back ? queue.tasks.pop_back() : queue.tasks.pop_front();
+                return _task;
+            };
+
+            // Newest own task first, it's most likely still in cache
+            std::optional<Task> _task = _take(*m_Queues[index], true);
+            for (std::size_t _i = 1; !_task && _i < m_Queues.size(); ++_i)
+                _task = _take(*m_Queues[(index + _i) % m_Queues.size()], false);
+
+            if (_task) {
+                std::lock_guard _lock{ m_Mutex };
+                --m_Pending;
+            }
+            return _task;
+        }
+
+        static void execute(const Task& task) {
+            task.call(task.fun, task.index);
+            task.remaining->fetch_sub(1, std::memory_order_release);
+        }
+
+        void work(std::size_t index) {
+            t_Pool = this, t_Index = index;
+            while (true) {
+                if (auto _task = pop(index)) {
+                    execute(*_task);
+                    continue;
+                }
+
+                std::unique_lock _lock{ m_Mutex };
+                m_Wake.wait(_lock, [this] { return m_Stop || m_Pending != 0; });
+                if (m_Stop) return;
+            }
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GUIJO_UTF8_SSE2
+#endif
+
+namespace Guijo::Utf8 {
+    constexpr char32_t Replacement = 0xFFFD; // Used for invalid sequences
+
+    // Length of the leading run of ASCII bytes, checked 16 bytes at a time.
+    inline std::size_t asciiPrefix(std::string_view str) {
+        const char* _data = str.data();
+        const std::size_t _size = str.size();
+        std::size_t _i = 0;
+#ifdef GUIJO_UTF8_SSE2
+        for (; _i + 16 <= _size; _i += 16) {
+            __m128i _chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_data + _i));
+            if (int _mask = _mm_movemask_epi8(_chunk)) // High bit set means non-ASCII
+                return _i + std::countr_zero(static_cast<unsigned int>(_mask));
+        }
+#else
+        for (; _i + 8 <= _size; _i += 8) {
+            std::uint64_t _chunk;
+            std::memcpy(&_chunk, _data + _i, 8);
+            if (std::uint64_t _mask = _chunk & 0x8080808080808080ull)
+                return _i + std::countr_zero(_mask) / 8;
+        }
+#endif
+        for (; _i < _size; ++_i)
+            if (static_cast<unsigned char>(_data[_i]) & 0x80) return _i;
+        return _size;
+    }
+
+    inline bool ascii(std::string_view str) { return asciiPrefix(str) == str.size(); }
+
+    // Decode a single sequence starting at 'i', advances 'i' past it.
+    inline char32_t next(std::string_view str, std::size_t& i) {
+        const auto _byte = [&](std::size_t n) { return static_cast<unsigned char>(str[n]); };
+        const auto _continuation = [&](std::size_t n) { return n < str.size() && (_byte(n) & 0xC0) == 0x80; };
+
+        const unsigned char _lead = _byte(i);
+        if (_lead < 0x80) return ++i, _lead;
+
+        std::size_t _length = 0;
+        char32_t _code = 0, _min = 0;
+        if ((_lead & 0xE0) == 0xC0) _length = 2, _code = _lead & 0x1F, _min = 0x80;
+        else if ((_lead & 0xF0) == 0xE0) _length = 3, _code = _lead & 0x0F, _min = 0x800;
+        else if ((_lead & 0xF8) == 0xF0) _length = 4, _code = _lead & 0x07, _min = 0x10000;
+        else return ++i, Replacement; // Stray continuation or invalid lead byte
+
+        for (std::size_t _n = 1; _n < _length; ++_n) {
+            if (!_continuation(i + _n)) return i += _n, Replacement; // Truncated
+            _code = (_code << 6) | (_byte(i + _n) & 0x3F);
+        }
+        i += _length;
+
+        // Reject overlong encodings, surrogates and out of range values
+        if (_code < _min || _code > 0x10FFFF || (_code >= 0xD800 && _code <= 0xDFFF))
+            return Replacement;
+        return _code;
+    }
+
+    // Decode the entire string in a single pass, appending to 'out'. Runs
+    // of ASCII are found 16 bytes at a time and widened without decoding.
+    inline void decode(std::string_view str, std::u32string& out) {
+        const std::size_t _offset = out.size();
+        out.resize(_offset + str.size()); // Never more codepoints than bytes
+        char32_t* _out = out.data() + _offset;
+        std::size_t _i = 0;
+        while (_i < str.size()) {
+            const std::size_t _ascii = _i + asciiPrefix(str.substr(_i));
+            for (; _i < _ascii; ++_i) *_out++ = static_cast<unsigned char>(str[_i]);
+            // Decode multi-byte sequences until the next ASCII byte
+            while (_i < str.size() && (static_cast<unsigned char>(str[_i]) & 0x80))
+                *_out++ = next(str, _i);
+        }
+        out.resize(_out - out.data());
+    }
+
+    // Amount of codepoints in the string
+    inline std::size_t length(std::string_view str) {
+        std::size_t _ascii = asciiPrefix(str);
+        if (_ascii == str.size()) return _ascii;
+        std::size_t _length = _ascii;
+        for (std::size_t _i = _ascii; _i < str.size(); ++_length) next(str, _i);
+        return _length;
+    }
+
+    // Call 'fun' with every codepoint, in a single pass. ASCII runs are found
+    // 16 bytes at a time and passed through as bytes, so pure ASCII strings
+    // are a plain byte loop after 1 vectorized scan.
+    template<class Fun>
+    inline void forEach(std::string_view str, Fun&& fun) {
+        std::size_t _i = 0;
+        while (_i < str.size()) {
+            const std::size_t _ascii = _i + asciiPrefix(str.substr(_i));
+            for (; _i < _ascii; ++_i) fun(static_cast<char32_t>(str[_i]));
+            // Decode multi-byte sequences until the next ASCII byte
+            while (_i < str.size() && (static_cast<unsigned char>(str[_i]) & 0x80))
+                fun(next(str, _i));
+        }
+    }
+}
\ No newline at end of file
@@ -42,10 +42,10 @@ namespace Guijo {
 
     private:
         template<class Op, class T, std::size_t ...Is>
-            requires requires(const T t) { (t.get<Is>(), ...); }
+            requires requires(const T t) { (t.template get<Is>(), ...); }
         constexpr Type operate(const T& other, std::index_sequence<Is...>) const {
             constexpr Op _op{};
-            return Type{ _op(m_Data[Is], other.get<Is>())... };
+            return Type{ _op(m_Data[Is], other.template get<Is>())... };
         }
         template<class Op, std::convertible_to<Ty> T, std::size_t ...Is>
         constexpr Type operate(const T& other, std::index_sequence<Is...>) const {
@@ -53,10 +53,10 @@ namespace Guijo {
             return Type{ _op(m_Data[Is], static_cast<Ty>(other))... };
         }
         template<class Op, class T, std::size_t ...Is>
-            requires requires(const T t) { (t.get<Is>(), ...); }
+            requires requires(const T t) { (t.template get<Is>(), ...); }
         constexpr Type& modify(const T& other, std::index_sequence<Is...>) {
             constexpr Op _op{};
-            ((m_Data[Is] = _op(m_Data[Is], other.get<Is>())), ...);
+            ((m_Data[Is] = _op(m_Data[Is], other.template get<Is>())), ...);
             return static_cast<Type>(*this);
         }        
         template<class Op, std::convertible_to<Ty> T, std::size_t ...Is>
@@ -66,9 +66,9 @@ namespace Guijo {
             return static_cast<Type>(*this);
         }        
         template<class T, std::size_t ...Is> 
-            requires requires(const T t) { (t.get<Is>(), ...); }
+            requires requires(const T t) { (t.template get<Is>(), ...); }
         constexpr Type& assign(const T& other, std::index_sequence<Is...>) {
-            ((m_Data[Is] = other.get<Is>()), ...);
+            ((m_Data[Is] = other.template get<Is>()), ...);
             return static_cast<Type>(*this);
         }        
         template<std::convertible_to<Ty> T, std::size_t ...Is>
@@ -77,9 +77,9 @@ namespace Guijo {
             return static_cast<Type>(*this);
         }       
         template<class T, std::size_t ...Is>
-            requires requires(const T t) { (t.get<Is>(), ...); }
+            requires requires(const T t) { (t.template get<Is>(), ...); }
         constexpr bool equals(const T& other, std::index_sequence<Is...>) const {
-            return ((m_Data[Is] == other.get<Is>()) && ...);
+            return ((m_Data[Is] == other.template get<Is>()) && ...);
         }
         template<std::convertible_to<Ty> T, std::size_t ...Is>
         constexpr bool equals(const T& other, std::index_sequence<Is...>) const {
@@ -104,14 +104,14 @@ namespace Guijo {
         constexpr Point(auto x, auto y) : Parent{ static_cast<Ty>(x), static_cast<Ty>(y) } {}
         constexpr Point(const Vec2<Ty>& p) : Parent{ p[0], p[1] } {}
 
-        constexpr Ty x() const { return this->get<0>(); }
-        constexpr Ty y() const { return this->get<1>(); }
+        constexpr Ty x() const { return this->template get<0>(); }
+        constexpr Ty y() const { return this->template get<1>(); }
 
         template<class T> constexpr operator Vec2<T>() const { return { static_cast<T>(x()), static_cast<T>(y()) }; }
         template<class T> constexpr operator Point<T>() const { return { static_cast<T>(x()), static_cast<T>(y()) }; }
 
-        constexpr void x(const Ty& v) { this->get<0>() = v; }
-        constexpr void y(const Ty& v) { this->get<1>() = v; }
+        constexpr void x(const Ty& v) { this->template get<0>() = v; }
+        constexpr void y(const Ty& v) { this->template get<1>() = v; }
 
         constexpr bool inside(const Dimensions<Ty>& v) const {
             return x() >= v.left() && x() <= v.right() && y() >= v.top() && y() <= v.bottom();
@@ -136,14 +136,14 @@ namespace Guijo {
         constexpr Size(auto x, auto y) : Parent{ static_cast<Ty>(x), static_cast<Ty>(y) } {}
         constexpr Size(const Vec2<Ty>& p) : Parent{ p[0], p[1] } {}
 
-        constexpr Ty width() const { return this->get<0>(); }
-        constexpr Ty height() const { return this->get<1>(); }
+        constexpr Ty width() const { return this->template get<0>(); }
+        constexpr Ty height() const { return this->template get<1>(); }
 
         template<class T> constexpr operator Vec2<T>() const { return { static_cast<T>(width()), static_cast<T>(height()) }; }
         template<class T> constexpr operator Size<T>() const { return { static_cast<T>(width()), static_cast<T>(height()) }; }
 
-        constexpr void width(const Ty& v) { this->get<0>() = v; }
-        constexpr void height(const Ty& v) { this->get<1>() = v; }
+        constexpr void width(const Ty& v) { this->template get<0>() = v; }
+        constexpr void height(const Ty& v) { this->template get<1>() = v; }
     };
 
     template<class Ty>
@@ -165,10 +165,10 @@ namespace Guijo {
         constexpr Dimensions(Ty x, const Vec2<Ty>& p, Ty h) : Parent{ static_cast<Ty>(x), p[0], p[1], static_cast<Ty>(h) } {}
         constexpr Dimensions(const Vec2<Ty>& p, Ty w, Ty h) : Parent{ p[0], p[1], static_cast<Ty>(w), static_cast<Ty>(h) } {}
 
-        constexpr virtual Ty x() const { return this->get<0>(); }
-        constexpr virtual Ty y() const { return this->get<1>(); }
-        constexpr virtual Ty width() const { return this->get<2>(); }
-        constexpr virtual Ty height() const { return this->get<3>(); }
+        constexpr virtual Ty x() const { return this->template get<0>(); }
+        constexpr virtual Ty y() const { return this->template get<1>(); }
+        constexpr virtual Ty width() const { return this->template get<2>(); }
+        constexpr virtual Ty height() const { return this->template get<3>(); }
         constexpr virtual Ty left() const { return x(); }
         constexpr virtual Ty top() const { return y(); }
         constexpr virtual Ty right() const { return x() + width(); }
@@ -180,10 +180,10 @@ namespace Guijo {
         template<class T> constexpr operator Vec4<T>() const { return { static_cast<T>(x()), static_cast<T>(y()), static_cast<T>(width()), static_cast<T>(height()) }; }
         template<class T> constexpr operator Dimensions<T>() const { return { static_cast<T>(x()), static_cast<T>(y()), static_cast<T>(width()), static_cast<T>(height()) }; }
 
-        constexpr virtual void x(const Ty& v) { this->get<0>() = v; }
-        constexpr virtual void y(const Ty& v) { this->get<1>() = v; }
-        constexpr virtual void width(const Ty& v) { this->get<2>() = v; }
-        constexpr virtual void height(const Ty& v) { this->get<3>() = v; }
+        constexpr virtual void x(const Ty& v) { this->template get<0>() = v; }
+        constexpr virtual void y(const Ty& v) { this->template get<1>() = v; }
+        constexpr virtual void width(const Ty& v) { this->template get<2>() = v; }
+        constexpr virtual void height(const Ty& v) { this->template get<3>() = v; }
         constexpr virtual void left(const Ty& v) { x(v); }
         constexpr virtual void top(const Ty& v) { y(v); }
         constexpr virtual void right(const Ty& v) { width(v - x()); }
@@ -0,0 +1,64 @@
+#pragma once
+#include "Guijo/pch.hpp"
+#include <condition_variable>
+
+namespace Guijo {
+    // Single background thread that runs one task at a time, so work can
+    // overlap with the calling thread. Starting a task waits for the last
+    // one first, exceptions are rethrown by the wait that finishes them.
+    class Worker {
+    public:
+        Worker() : m_Thread([this] { work(); }) {}
+
+        ~Worker() {
+            {
+                std::unique_lock _lock{ m_Mutex };
+                m_Done.wait(_lock, [this] { return !m_Task; });
+                m_Stop = true;
+            }
+            m_Wake.notify_one();
+            m_Thread.join();
+        }
+
+        void start(std::function<void()> task) {
+            wait();
+            {
+                std::lock_guard _lock{ m_Mutex };
+                m_Task = std::move(task);
+            }
+            m_Wake.notify_one();
+        }
+
+        // Block until the running task, if any, has finished
+        void wait() {
+            std::unique_lock _lock{ m_Mutex };
+            m_Done.wait(_lock, [this] { return !m_Task; });
+            if (m_Exception) std::rethrow_exception(std::exchange(m_Exception, nullptr));
+        }
+
+    private:
+        std::mutex m_Mutex;
+        std::condition_variable m_Wake; // Signals a task or stopping to the thread
+        std::condition_variable m_Done; // Signals a finished task to waiters
+        std::function<void()> m_Task{};
+        std::exception_ptr m_Exception{};
+        bool m_Stop = false;
+        std::thread m_Thread; // Last, so it starts after the rest is constructed
+
+        void work() {
+            std::unique_lock _lock{ m_Mutex };
+            while (true) {
+                m_Wake.wait(_lock, [this] { return m_Stop || m_Task; });
+                if (m_Stop) return;
+
+                _lock.unlock();
+                try { m_Task(); }
+                catch (...) { m_Exception = std::current_exception(); }
+                _lock.lock();
+
+                m_Task = nullptr;
+                m_Done.notify_all();
+            }
+        }
+    };
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "Guijo/pch.hpp"
 #include "Guijo/Objects/Object.hpp"
 #include "Guijo/Event/BasicEvents.hpp"
+#include <condition_variable>
+#include <optional>
 
 namespace Guijo {
     class WindowBase : public Object {
@@ -14,7 +16,41 @@ namespace Guijo {
         WindowBase(WindowBase&&) = delete;
         WindowBase(const WindowBase&) = delete;
 
-        virtual bool loop() = 0;
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        virtual bool loop() = 0;  // Handle pending input, false once the window closed
+        virtual void frame() = 0; // Layout, update and render
+
+        // Render a frame, remembering whether transitions were still running,
+        // in which case the next loop renders once more for the final values.
+        void render() { frame(); m_Animating = animating(); }
+
+        // Whether the next loop has to render, the Gui skips the frame otherwise
+        bool needsFrame() { return redraw || box.needsLayout() || m_Animating || animating(); }
+        bool animating() { return animations.animating() || AnimationScheduler::global().animating(); }
+
+        // Block the calling thread until there's input, wake() is called
+        // or the deadline has passed. Without deadline it waits indefinitely.
+        static void wait(std::optional<TimePoint> until);
+        static void wake();
+
+        // Block until the display's next vertical blank
+        static void verticalBlank();
+
+        AnimationScheduler animations{}; // Transitions started while handling this window
+        bool redraw = true;              // Render the next frame, set by input and resizes
+
+        // Lay out on a worker thread while the last committed frame renders,
+        // instead of one after the other. Frames are shown one frame later,
+        // resizing still renders right away. Layout hooks (measure, arrange)
+        // then run on the worker: they may measure text, which Font::lock()
+        // guards, but must not touch the graphics context.
+        bool pipelined = false;
+
+        // Moves and drags queued right after each other are dispatched as
+        // one, with the latest position. This keeps the positions in between
+        // in their history, for pen input.
+        bool pointerHistory = false;
 
         struct CursorState {
             MouseButtons buttons = 0;
@@ -24,11 +60,39 @@ namespace Guijo {
 
     protected:
         Graphics m_Graphics{};
+        bool m_Animating = false; // Transitions were running during the last render
     };
 }
 
 #ifdef WIN32
 #include "WindowsWindow.hpp"
 #else
+namespace Guijo {
+    // Without a platform message queue only wake() and timeouts end a wait
+    namespace Internal {
+        inline std::mutex waitMutex;
+        inline std::condition_variable waitCondition;
+        inline bool woken = false;
+    }
+
+    inline void WindowBase::wait(std::optional<TimePoint> until) {
+        std::unique_lock _lock{ Internal::waitMutex };
+        const auto _woken = [] { return Internal::woken; };
+        if (until) Internal::waitCondition.wait_until(_lock, *until, _woken);
+        else Internal::waitCondition.wait(_lock, _woken);
+        Internal::woken = false;
+    }
+
+    inline void WindowBase::wake() {
+        {
+            std::lock_guard _lock{ Internal::waitMutex };
+            Internal::woken = true;
+        }
+        Internal::waitCondition.notify_one();
+    }
+
+    inline void WindowBase::verticalBlank() {}
+}
+
 using Window = WindowBase;
 #endif
\ No newline at end of file
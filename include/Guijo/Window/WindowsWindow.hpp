@@ -2,6 +2,7 @@
 #include "Guijo/pch.hpp"
 #include "Guijo/Objects/Object.hpp"
 #include "Guijo/Event/BasicEvents.hpp"
+#include "Guijo/Event/EventQueue.hpp"
 
 namespace Guijo {
     class Window : public WindowBase {
@@ -38,15 +39,25 @@ namespace Guijo {
         WNDCLASS m_WindowClass{};
         HWND m_Handle{};
         std::size_t m_Id{};
-        std::queue<std::unique_ptr<Event>> m_EventQueue;
+        EventQueue m_EventQueue;
         bool m_ShouldExit = false;
+        bool m_Presented = true; // The committed frame has been rendered
 
         HCURSOR m_ArrorCursor = LoadCursor(NULL, IDC_ARROW);
 
         bool createWindow(const Construct& c);
 
         bool loop() override;
-        void windowsLoop();
+        void frame() override;
+        void present(); // Render the committed frame
+
+        // Queue input, handling the oldest event first when the queue is full
+        template<class Ty> void queue(const Ty& e) {
+            while (!m_EventQueue.push(e)) {
+                handle(m_EventQueue.front());
+                m_EventQueue.pop();
+            }
+        }
 
         void cursorEvent(float x, float y, KeyMod mod);
         void mouseButtonEvent(MouseButton button, bool press, KeyMod mod);
@@ -16,6 +16,7 @@
 #include <cmath>
 #include <codecvt>
 #include <concepts>
+#include <cstring>
 #include <cstddef>
 #include <filesystem>
 #include <functional>
@@ -27,6 +28,7 @@
 #include <memory>
 #include <mutex>
 #include <numbers>
+#include <numeric>
 #include <queue>
 #include <ranges>
 #include <regex>
@@ -43,6 +45,7 @@
 #include <variant>
 #include <vector>
 
+#ifdef _WIN32
 #define NOMINMAX
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -50,4 +53,5 @@
 #include <unknwn.h>
 #include <windowsx.h>
 #include <ShlObj_core.h>
-#undef RGB
\ No newline at end of file
+#undef RGB
+#endif
\ No newline at end of file
@@ -1,113 +1,236 @@
 #include "Guijo/Graphics/Font.hpp"
 #include "Guijo/Graphics/Graphics.hpp"
+#include "Guijo/Utils/Utf8.hpp"
 
 #define CHECK(x, msg, then) if (auto error = x) { std::cout << msg << '\n'; then; }
 
 using namespace Guijo;
 
-Font::CharMap::CharMap(int size, FT_Face& face) 
-    : m_Size(size), m_Face(face) { initialize(); }
+Font::Usage Font::memory{};
 
-Font::CharMap::Character& Font::CharMap::character(char c) {
-    if (c < 0) return m_CharMap[0];
-    else return m_CharMap[c];
+Font::CharMap::CharMap(int size, FT_Face& face, std::uint64_t hash) 
+    : m_Size(size), m_Hash(hash), m_Face(face) {
+    memory.cpu += sizeof(CharMap);
+    ++memory.sizes;
+    initialize(); 
 }
 
-void Font::CharMap::initialize() {
-    FT_Set_Pixel_Sizes(m_Face, 0, m_Size);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+Font::CharMap::~CharMap() {
+    // Textures are only deleted on eviction, the context may be gone here
+    memory.cpu -= sizeof(CharMap) + m_Pages.size() * sizeof(Page);
+    memory.gpu -= m_Pages.size() * textureBytes();
+    memory.pages -= m_Pages.size();
+    --memory.sizes;
+}
 
-    int _width = m_Size;
-    int _height = m_Size;
+Font::CharMap::Character& Font::CharMap::character(char32_t c) {
+    if (c < PageSize && m_Ascii) {
+        m_Ascii->used = frame;
+        return m_Ascii->characters[c];
+    }
+    return page(c / PageSize).characters[c % PageSize];
+}
 
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
-    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, _width, _height, 128, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+Font::CharMap::Page& Font::CharMap::page(char32_t index) {
+    auto _it = m_Pages.find(index);
+    if (_it != m_Pages.end()) {
+        _it->second.used = frame;
+        return _it->second;
+    }
 
+    auto& _page = m_Pages[index];
+    load(_page, index);
+    _page.used = frame;
+    if (index == 0) m_Ascii = &_page;
+
+    memory.cpu += sizeof(Page);
+    memory.gpu += textureBytes();
+    ++memory.pages;
+    return _page;
+}
+
+void Font::CharMap::release(char32_t id) {
+    auto _it = m_Pages.find(id);
+    if (_it == m_Pages.end()) return;
+
+    if (_it->second.texture) glDeleteTextures(1, &_it->second.texture);
+    if (id == 0) m_Ascii = nullptr;
+    m_Pages.erase(_it);
+
+    memory.cpu -= sizeof(Page);
+    memory.gpu -= textureBytes();
+    --memory.pages;
+}
+
+void Font::CharMap::initialize() {
+    FT_Set_Pixel_Sizes(m_Face, 0, m_Size);
     m_Ascender = m_Face->size->metrics.ascender / 64.f;
     m_Descender = m_Face->size->metrics.descender / 64.f;
     m_Height = m_Face->size->metrics.height / 64.f;
+    page(0);
+}
 
-    unsigned char* empty = new unsigned char[_width * _height * 4];
-    for (int i = 0; i < _width * _height * 4; i++)
-        empty[i] = 0;
-
-    for (unsigned int _c = 0; _c < 128; _c++) {
-        if (FT_Load_Char(m_Face, _c, FT_LOAD_DEFAULT)) {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph\n";
-            continue;
-        }
+bool Font::CharMap::loadFromCache(Page& page, char32_t id) {
+    GlyphCache::Header _expected{
+        .key{ m_Hash, m_Size, FT_RENDER_MODE_LCD, static_cast<std::int32_t>(id) },
+        .width = m_Size, .height = m_Size, .count = PageSize,
+    };
 
-        if (FT_Render_Glyph(m_Face->glyph, FT_RENDER_MODE_LCD)) {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph\n";
-            continue;
-        }
+    auto _mapping = GlyphCache::open(_expected);
+    if (!_mapping) return false;
 
-        Character _character = {
-            _c,
-            { m_Face->glyph->bitmap.width / 3, m_Face->glyph->bitmap.rows },
-            { m_Face->glyph->bitmap_left, m_Face->glyph->bitmap_top },
-            static_cast<unsigned int>(m_Face->glyph->advance.x)
+    for (std::size_t _c = 0; _c < PageSize; _c++) {
+        auto& _glyph = _mapping.glyphs()[_c];
+        page.characters[_c] = {
+            _glyph.index,
+            { _glyph.width, _glyph.height },
+            { _glyph.bearingX, _glyph.bearingY },
+            _glyph.advance
         };
+    }
 
-        // Coords of small array
-        int subx = 0;
-        int suby = -(_height - _character.size.height()); // Initial offset for y
-        for (int y = 0; y < _height; y++) {
-            for (int x = 0; x < _width * 4; x++) {
-                // Default value = 0
-                unsigned char value = 0;
-
-                // Don't get alpha values, because they don't exist
-                bool notAlpha = (x % 4) != 3;
-
-                // Make sure subx and suby within boundaries
-                if (notAlpha && subx < static_cast<int>(m_Face->glyph->bitmap.width) &&
-                    suby >= 0 && suby < static_cast<int>(m_Face->glyph->bitmap.rows)) {
-                    // Sub index using amount of bytes * y + x
-                    int subindex = suby * m_Face->glyph->bitmap.pitch + subx;
-                    value = m_Face->glyph->bitmap.buffer[subindex];
-                    subx++; // Increment the x
-                }
+    // Layers are uploaded straight from the mapped file when first drawn
+    page.mapping = std::move(_mapping);
+    return true;
+}
+
+void Font::CharMap::load(Page& page, char32_t id) {
+    if (!loadFromCache(page, id)) {
+        FT_Set_Pixel_Sizes(m_Face, 0, m_Size);
+
+        int _width = m_Size;
+        int _height = m_Size;
+        std::size_t _layer = _width * _height * 4;
 
-                // Index in bigger array
-                int index = y * (_width * 4) + x;
-                empty[index] = value;
+        // Render all layers into a single buffer, so it can be
+        // uploaded in one go, and stored in the glyph cache.
+        std::vector<unsigned char> _pixels(_layer * PageSize, 0);
+        GlyphCache::Glyph _glyphs[PageSize]{};
+        bool _complete = true;
+
+        for (unsigned int _l = 0; _l < PageSize; _l++) {
+            const char32_t _c = id * PageSize + _l;
+            if (FT_Load_Char(m_Face, _c, FT_LOAD_DEFAULT)) {
+                std::cout << "ERROR::FREETYTPE: Failed to load Glyph\n";
+                _complete = false;
+                continue;
+            }
+
+            if (FT_Render_Glyph(m_Face->glyph, FT_RENDER_MODE_LCD)) {
+                std::cout << "ERROR::FREETYTPE: Failed to load Glyph\n";
+                _complete = false;
+                continue;
+            }
+
+            Character _character = {
+                _l,
+                { m_Face->glyph->bitmap.width / 3, m_Face->glyph->bitmap.rows },
+                { m_Face->glyph->bitmap_left, m_Face->glyph->bitmap_top },
+                static_cast<unsigned int>(m_Face->glyph->advance.x)
+            };
+
+            unsigned char* _empty = &_pixels[_l * _layer];
+
+            // Coords of small array
+            int subx = 0;
+            int suby = -(_height - _character.size.height()); // Initial offset for y
+            for (int y = 0; y < _height; y++) {
+                for (int x = 0; x < _width * 4; x++) {
+                    // Default value = 0
+                    unsigned char value = 0;
+
+                    // Don't get alpha values, because they don't exist
+                    bool notAlpha = (x % 4) != 3;
+
+                    // Make sure subx and suby within boundaries
+                    if (notAlpha && subx < static_cast<int>(m_Face->glyph->bitmap.width) &&
+                        suby >= 0 && suby < static_cast<int>(m_Face->glyph->bitmap.rows)) {
+                        // Sub index using amount of bytes * y + x
+                        int subindex = suby * m_Face->glyph->bitmap.pitch + subx;
+                        value = m_Face->glyph->bitmap.buffer[subindex];
+                        subx++; // Increment the x
+                    }
+
+                    // Index in bigger array
+                    int index = y * (_width * 4) + x;
+                    _empty[index] = value;
+                }
+                subx = 0; // reset x
+                suby++;   // increment y
             }
-            subx = 0; // reset x
-            suby++;   // increment y
+
+            page.characters[_l] = _character;
+            _glyphs[_l] = {
+                _character.index,
+                _character.size.width(), _character.size.height(),
+                _character.bearing.x(), _character.bearing.y(),
+                _character.advance
+            };
         }
 
-        glTexSubImage3D(
-            GL_TEXTURE_2D_ARRAY,
-            0, 0, 0, _c,
-            _width,
-            _height,
-            1, GL_RGBA,
-            GL_UNSIGNED_BYTE,
-            empty
-        );
-
-        m_CharMap[_c] = _character;
+        // Only cache complete pages, so failed glyphs are retried next launch
+        if (_complete) GlyphCache::store({ 
+            .key{ m_Hash, m_Size, FT_RENDER_MODE_LCD, static_cast<std::int32_t>(id) },
+            .width = _width, .height = _height, .count = PageSize,
+            .ascender = m_Ascender, .descender = m_Descender, .lineHeight = m_Height,
+        }, _glyphs, _pixels.data());
+
+        page.pixels = std::move(_pixels); // Uploaded when first drawn
     }
+}
+
+unsigned int Font::CharMap::texture(Page& page) {
+    if (page.texture) return page.texture;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, m_Size, m_Size, PageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, 
+        page.mapping ? page.mapping.pixels() : page.pixels.data());
+
+    // Pixels live on the GPU now
+    page.pixels = {};
+    page.mapping = {};
+
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
-    delete[] empty;
+    return page.texture;
+}
+
+void Font::Coverage::add(char32_t c) {
+    const std::size_t _word = c / 64;
+    if (_word >= m_Bits.size()) m_Bits.resize(_word + 1, 0);
+    m_Bits[_word] |= 1ull << (c % 64);
 }
 
-Font::Font(std::string_view path) : m_Path(path) {
+std::size_t Font::Coverage::count() const {
+    std::size_t _count = 0;
+    for (auto _bits : m_Bits) _count += std::popcount(_bits);
+    return _count;
+}
+
+Font::Font(std::string_view path) : m_Path(path), m_Hash(GlyphCache::fontKey(path)) {
     ++references;
     if (!library)
         CHECK(FT_Init_FreeType(&library), "Failed to initialize FreeType2 library", return);
 
     CHECK(FT_New_Face(library, m_Path.c_str(), 0, &m_Face), "Failed to open font file " << path, return);
+
+    // Walk the charmap once, instead of probing FT_Get_Char_Index per glyph
+    FT_UInt _index = 0;
+    FT_ULong _c = FT_Get_First_Char(m_Face, &_index);
+    while (_index != 0) {
+        if (_c <= 0x10FFFF) m_Coverage.add(static_cast<char32_t>(_c));
+        _c = FT_Get_Next_Char(m_Face, _c, &_index);
+    }
 }
 
-Font::Font(const Font& other) : m_Path(other.m_Path) {
+Font::Font(const Font& other) 
+    : fallback(other.fallback), m_Path(other.m_Path), m_Hash(other.m_Hash), m_Coverage(other.m_Coverage) {
     ++references;
     CHECK(FT_New_Face(library, m_Path.c_str(), 0, &m_Face), "Failed to open font file " << m_Path, return);
 }
@@ -120,28 +243,215 @@ Font::~Font() {
 }
 
 Font::CharMap& Font::size(int size) {
-    return m_SizeMap.contains(size)
-        ? m_SizeMap.find(size)->second
-        : m_SizeMap.insert({ size, { size, m_Face } }).first->second;
+    return m_SizeMap.try_emplace(size, size, m_Face, m_Hash).first->second;
 }
 
-bool Font::load(std::string_view name) {
-    using namespace std::string_literals;
-    TCHAR szPath[MAX_PATH];
-    SHGetFolderPathA(nullptr, CSIDL_FONTS, nullptr, 0, szPath);
+void Font::tick() {
+    auto _lock = lock();
+    ++frame;
+}
+
+void Font::evict() {
+    auto _lock = lock();
+    if (memory.bytes() <= budget) return;
+    const auto _target = static_cast<std::size_t>(budget * std::clamp(retain, 0., 1.));
+
+    struct Candidate {
+        std::uint64_t used;
+        Font* font;
+        int size;
+        char32_t page;
+    };
+
+    // Only runs when over budget, so simply sort all pages by last use.
+    // The renderer only draws with fonts it loaded, those are all here.
+    std::vector<Candidate> _candidates;
+    for (auto& [_name, _font] : GraphicsBase::Fonts)
+        for (auto& [_size, _charMap] : _font.m_SizeMap)
+            for (auto& [_id, _page] : _charMap.m_Pages)
+                if (_page.used < frame) _candidates.push_back({ _page.used, &_font, _size, _id });
+    std::ranges::sort(_candidates, {}, &Candidate::used);
+
+    for (auto& _candidate : _candidates) {
+        if (memory.bytes() <= _target) break;
+        auto _it = _candidate.font->m_SizeMap.find(_candidate.size);
+        _it->second.release(_candidate.page);
+        ++memory.evictions;
 
-    std::string _noExtension = szPath;
-    _noExtension += "/"s + name.data();
-    std::filesystem::path _font = _noExtension + ".ttf";
+        // Also drop sizes without any pages, so sizes used once don't stay around
+        if (_it->second.m_Pages.empty()) _candidate.font->m_SizeMap.erase(_it);
+    }
+}
+
+const std::vector<Font*>& Font::chain() {
+    const bool _current = !m_Chain.empty() 
+        && m_ChainNames.size() == fallback.size() + Fallback.size()
+        && std::equal(fallback.begin(), fallback.end(), m_ChainNames.begin())
+        && std::equal(Fallback.begin(), Fallback.end(), m_ChainNames.begin() + fallback.size());
+    if (_current) return m_Chain;
+
+    m_ChainNames = fallback;
+    m_ChainNames.insert(m_ChainNames.end(), Fallback.begin(), Fallback.end());
+
+    // Missing fonts are only looked for again once the names change
+    m_Chain.assign(m_ChainNames.size() + 1, nullptr);
+    m_Chain[0] = this;
+    m_Resolved = 1;
+    ++m_Generation;
+    return m_Chain;
+}
+
+std::size_t Font::select(char32_t c) {
+    if (m_Coverage.contains(c)) return 0;
+
+    auto& _chain = chain();
+    for (std::size_t _i = 1; _i < _chain.size(); ++_i) {
+        if (_i == m_Resolved) { // Not looked up yet
+            auto& _name = m_ChainNames[_i - 1];
+            auto _it = GraphicsBase::Fonts.find(_name);
+            if (_it == GraphicsBase::Fonts.end() && load(_name))
+                _it = GraphicsBase::Fonts.find(_name);
+            if (_it != GraphicsBase::Fonts.end() && &_it->second != this) m_Chain[_i] = &_it->second;
+            ++m_Resolved;
+        }
+        if (_chain[_i] && _chain[_i]->m_Coverage.contains(c)) return _i;
+    }
+    return 0;
+}
+
+namespace {
+    // Lowercase without spaces, so "Segoe UI" matches "segoeui"
+    std::string normalize(std::string_view str) {
+        std::string _result;
+        for (char _c : str) if (_c != ' ' && _c != '-' && _c != '_')
+            _result += static_cast<char>(std::tolower(static_cast<unsigned char>(_c)));
+        return _result;
+    }
+
+    // Index of font file names and family names in the font directories.
+    // Family names need every font opened, so the index is stored next to
+    // the glyph cache, and only built again when a font directory changed.
+    class FontIndex {
+    public:
+        using Index = std::map<std::string, std::filesystem::path, std::less<>>;
+
+        FontIndex(const std::vector<std::filesystem::path>& directories) {
+            namespace fs = std::filesystem;
+            std::error_code _error;
+            for (auto& _directory : directories) {
+                auto _time = fs::last_write_time(_directory, _error);
+                m_Stamp += _directory.string() + '\t' 
+                    + std::to_string(_error ? 0 : _time.time_since_epoch().count()) + '\n';
+            }
+
+            const bool _stored = GlyphCache::enabled;
+            if (_stored && read()) return;
+            build(directories);
+            if (_stored) write();
+        }
 
-    if (std::filesystem::exists(_font)) {
-        char* _name = new char[name.size() + 1];
-        for (int i = 0; i < name.size(); i++)
-            _name[i] = name[i];
-        _name[name.size()] = '\0';
-        GraphicsBase::Fonts.emplace(_name, Guijo::Font{ _font.string() });
-        return true;
-    } else return false;
+        std::filesystem::path find(std::string_view name) const {
+            auto _it = m_Index.find(name);
+            return _it != m_Index.end() ? _it->second : std::filesystem::path{};
+        }
+
+    private:
+        Index m_Index{};
+        std::string m_Stamp{}; // Directories and their modification times
+
+        static std::filesystem::path file() { return GlyphCache::root() / "fonts.index"; }
+
+        // Stamp, empty line, then a name and path per line
+        bool read() {
+            std::ifstream _file{ file() };
+            if (!_file) return false;
+            std::string _line, _stamp;
+            while (std::getline(_file, _line) && !_line.empty()) _stamp += _line + '\n';
+            if (_stamp != m_Stamp) return false;
+            while (std::getline(_file, _line)) {
+                const auto _tab = _line.find('\t');
+                if (_tab == std::string::npos) continue;
+                const std::u8string _path{ _line.begin() + _tab + 1, _line.end() }; // Paths are UTF-8
+                m_Index.try_emplace(_line.substr(0, _tab), _path);
+            }
+            return true;
+        }
+
+        void write() const {
+            std::error_code _error;
+            std::filesystem::create_directories(file().parent_path(), _error);
+            std::ofstream _file{ file(), std::ios::trunc };
+            if (!_file) return;
+            _file << m_Stamp << '\n';
+            for (auto& [_name, _path] : m_Index) {
+                const std::u8string _utf8 = _path.u8string();
+                _file << _name << '\t' << std::string{ _utf8.begin(), _utf8.end() } << '\n';
+            }
+        }
+
+        void build(const std::vector<std::filesystem::path>& directories) {
+            namespace fs = std::filesystem;
+            std::error_code _error;
+            constexpr std::string_view _extensions[]{ ".ttf", ".otf", ".ttc" };
+            std::vector<fs::path> _files;
+            for (auto& _directory : directories)
+                for (auto& _entry : fs::directory_iterator{ _directory, _error }) {
+                    std::string _extension = normalize(_entry.path().extension().string());
+                    if (std::ranges::find(_extensions, _extension) == std::end(_extensions)) continue;
+                    _files.push_back(_entry.path());
+                    m_Index.try_emplace(normalize(_entry.path().stem().string()), _entry.path());
+                }
+
+            // Family names need the face, use a separate library so it does
+            // not interfere with the reference count of the shared one.
+            FT_Library _library;
+            if (FT_Init_FreeType(&_library)) return;
+            for (auto& _file : _files) {
+                FT_Face _face;
+                if (FT_New_Face(_library, _file.string().c_str(), 0, &_face)) continue;
+                if (_face->family_name) {
+                    std::string _family = normalize(_face->family_name);
+                    std::string _style = _face->style_name ? normalize(_face->style_name) : "";
+                    m_Index.try_emplace(_family + _style, _file);
+                    if (_style == "regular" || _style.empty()) m_Index.try_emplace(_family, _file);
+                }
+                FT_Done_Face(_face);
+            }
+            FT_Done_FreeType(_library);
+        }
+    };
+}
+
+std::filesystem::path Font::find(std::string_view name) {
+    namespace fs = std::filesystem;
+    std::error_code _error;
+    if (fs::is_regular_file(name, _error)) return name; // Already a path
+
+    // System fonts, and fonts installed for the current user only
+    std::vector<fs::path> _directories;
+    char _path[MAX_PATH];
+    if (SHGetFolderPathA(nullptr, CSIDL_FONTS, nullptr, 0, _path) == 0)
+        _directories.emplace_back(_path);
+    if (SHGetFolderPathA(nullptr, CSIDL_LOCAL_APPDATA, nullptr, 0, _path) == 0)
+        _directories.push_back(fs::path{ _path } / "Microsoft" / "Windows" / "Fonts");
+
+    constexpr std::string_view _extensions[]{ ".ttf", ".otf", ".ttc" };
+    for (auto& _directory : _directories) 
+        for (auto& _extension : _extensions) {
+            fs::path _font = _directory / (std::string{ name } + std::string{ _extension });
+            if (fs::exists(_font, _error)) return _font;
+        }
+
+    // Not a file name, look through the index, made on the first miss
+    static const FontIndex _index{ _directories };
+    return _index.find(normalize(name));
+}
+
+bool Font::load(std::string_view name) {
+    auto _font = find(name);
+    if (_font.empty()) return false;
+    GraphicsBase::Fonts.emplace(name, Guijo::Font{ _font.string() });
+    return true;
 }
 
 void Font::load(std::string_view path, std::string_view name) {
@@ -149,19 +459,25 @@ void Font::load(std::string_view path, std::string_view name) {
 }
 
 float Font::width(const char c, std::string_view font, float size) {
+    auto _lock = lock(); // Measured on layout threads
     if (!GraphicsBase::Fonts.contains(font)) return 0;
     float _scale = size / std::round(size);
     return _scale * static_cast<float>((*GraphicsBase::Fonts.find(font))
-        .second.size(static_cast<int>(size)).character(c).advance >> 6);
+        .second.size(static_cast<int>(size)).character(static_cast<unsigned char>(c)).advance >> 6);
 }
 
 float Font::width(std::string_view c, std::string_view font, float size) {
+    auto _lock = lock(); // Measured on layout threads
     if (!GraphicsBase::Fonts.contains(font)) return 0;
     float _scale = size / std::round(size);
     float _width = 0;
-    auto& _font = (*GraphicsBase::Fonts.find(font))
-        .second.size(static_cast<int>(size));
-    for (auto& _c : c)
-        _width += _font.character(_c).advance >> 6;
+    auto& _font = (*GraphicsBase::Fonts.find(font)).second;
+    auto& _chain = _font.chain();
+    auto& _charMap = _font.size(static_cast<int>(size));
+    Utf8::forEach(c, [&](char32_t _c) {
+        const std::size_t _i = _font.select(_c);
+        auto& _map = _i == 0 ? _charMap : _chain[_i]->size(static_cast<int>(size));
+        _width += _map.character(_c).advance >> 6;
+    });
     return _width * _scale;
 }
\ No newline at end of file
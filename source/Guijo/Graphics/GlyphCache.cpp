@@ -0,0 +1,201 @@
+#include "Guijo/Graphics/GlyphCache.hpp"
+#include <iomanip>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Guijo;
+
+GlyphCache::Mapping::Mapping(Mapping&& other) noexcept { *this = std::move(other); }
+
+GlyphCache::Mapping& GlyphCache::Mapping::operator=(Mapping&& other) noexcept {
+    release();
+    std::swap(m_Data, other.m_Data);
+    std::swap(m_Size, other.m_Size);
+#ifdef WIN32
+    std::swap(m_File, other.m_File);
+    std::swap(m_Map, other.m_Map);
+#endif
+    return *this;
+}
+
+GlyphCache::Mapping::~Mapping() { release(); }
+
+void GlyphCache::Mapping::release() {
+#ifdef WIN32
+    if (m_Data) UnmapViewOfFile(m_Data);
+    if (m_Map) CloseHandle(m_Map);
+    if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+    m_File = INVALID_HANDLE_VALUE;
+    m_Map = nullptr;
+#else
+    if (m_Data) munmap(const_cast<std::uint8_t*>(m_Data), m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+std::uint64_t GlyphCache::hash(const std::uint8_t* data, std::size_t size, std::uint64_t seed) {
+    // FNV-1a, processed 8 bytes per round to keep it cheap on large layers
+    std::uint64_t _hash = seed;
+    std::size_t _i = 0;
+    for (; _i + 8 <= size; _i += 8) {
+        std::uint64_t _word;
+        std::memcpy(&_word, data + _i, 8);
+        _hash = (_hash ^ _word) * Prime;
+    }
+    for (; _i < size; ++_i)
+        _hash = (_hash ^ data[_i]) * Prime;
+    return _hash;
+}
+
+std::uint64_t GlyphCache::fontKey(std::string_view path) {
+    namespace fs = std::filesystem;
+    std::error_code _error;
+    const fs::path _path = fs::absolute(fs::path{ path }, _error);
+    if (_error) return 0;
+    const auto _size = fs::file_size(_path, _error);
+    if (_error) return 0;
+    const auto _time = fs::last_write_time(_path, _error);
+    if (_error) return 0;
+
+    const std::string _name = _path.string();
+    const std::uint64_t _stamp[2]{ static_cast<std::uint64_t>(_size),
+        static_cast<std::uint64_t>(_time.time_since_epoch().count()) };
+    const std::uint64_t _hash = hash(reinterpret_cast<const std::uint8_t*>(_name.data()), _name.size());
+    return hash(reinterpret_cast<const std::uint8_t*>(_stamp), sizeof(_stamp), _hash);
+}
+
+std::filesystem::path GlyphCache::root() {
+    std::filesystem::path _directory = directory;
+    if (_directory.empty()) {
+#ifdef WIN32
+        char _appData[MAX_PATH];
+        if (SHGetFolderPathA(nullptr, CSIDL_LOCAL_APPDATA, nullptr, 0, _appData) == 0)
+            _directory = std::filesystem::path{ _appData } / "Guijo" / "GlyphCache";
+        else _directory = std::filesystem::temp_directory_path() / "Guijo" / "GlyphCache";
+#else
+        _directory = std::filesystem::temp_directory_path() / "Guijo" / "GlyphCache";
+#endif
+    }
+    return _directory;
+}
+
+std::filesystem::path GlyphCache::path(const Key& key) {
+    std::ostringstream _name;
+    _name << std::hex << std::setw(16) << std::setfill('0') << key.font
+        << std::dec << '-' << key.size << '-' << key.mode << '-' << key.page << ".glyphs";
+    return root() / _name.str();
+}
+
+std::size_t GlyphCache::pixelBytes(const Header& header) {
+    return static_cast<std::size_t>(header.width) * header.height * header.count * 4;
+}
+
+GlyphCache::Mapping GlyphCache::open(const Header& expected) {
+    Mapping _mapping{};
+    if (!enabled || expected.key.font == 0) return _mapping;
+
+    const auto _path = path(expected.key).string();
+    const std::size_t _expectedSize = sizeof(Header)
+        + expected.count * sizeof(Glyph) + pixelBytes(expected);
+
+#ifdef WIN32
+    _mapping.m_File = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_mapping.m_File == INVALID_HANDLE_VALUE) return _mapping;
+
+    LARGE_INTEGER _size{};
+    if (!GetFileSizeEx(_mapping.m_File, &_size)
+        || static_cast<std::size_t>(_size.QuadPart) != _expectedSize) {
+        _mapping.release();
+        return _mapping;
+    }
+
+    _mapping.m_Map = CreateFileMappingA(_mapping.m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping.m_Map == nullptr) {
+        _mapping.release();
+        return _mapping;
+    }
+
+    _mapping.m_Data = static_cast<const std::uint8_t*>(
+        MapViewOfFile(_mapping.m_Map, FILE_MAP_READ, 0, 0, 0));
+    _mapping.m_Size = _expectedSize;
+#else
+    int _file = ::open(_path.c_str(), O_RDONLY);
+    if (_file < 0) return _mapping;
+
+    struct stat _stat{};
+    if (fstat(_file, &_stat) != 0 || static_cast<std::size_t>(_stat.st_size) != _expectedSize) {
+        close(_file);
+        return _mapping;
+    }
+
+    void* _data = mmap(nullptr, _expectedSize, PROT_READ, MAP_PRIVATE, _file, 0);
+    close(_file);
+    if (_data == MAP_FAILED) return _mapping;
+    _mapping.m_Data = static_cast<const std::uint8_t*>(_data);
+    _mapping.m_Size = _expectedSize;
+#endif
+    if (!_mapping) return _mapping;
+
+    // Validate the header against the expected key and layout
+    const Header& _header = _mapping.header();
+    const bool _valid = _header.magic == Magic
+        && _header.version == Version
+        && _header.key.font == expected.key.font
+        && _header.key.size == expected.key.size
+        && _header.key.mode == expected.key.mode
+        && _header.key.page == expected.key.page
+        && _header.width == expected.width
+        && _header.height == expected.height
+        && _header.count == expected.count;
+
+    // And the payload against the stored checksum
+    if (!_valid || _header.checksum != hash(_mapping.pixels(), pixelBytes(_header),
+        hash(reinterpret_cast<const std::uint8_t*>(_mapping.glyphs()), _header.count * sizeof(Glyph)))) {
+        _mapping.release();
+        std::error_code _ec;
+        std::filesystem::remove(_path, _ec); // Stale or corrupt, rebuild next time
+    }
+
+    return _mapping;
+}
+
+bool GlyphCache::store(const Header& header, const Glyph* glyphs, const std::uint8_t* pixels) {
+    if (!enabled || header.key.font == 0) return false;
+
+    const auto _path = path(header.key);
+    std::error_code _ec;
+    std::filesystem::create_directories(_path.parent_path(), _ec);
+    if (_ec) return false;
+
+    const std::size_t _glyphBytes = header.count * sizeof(Glyph);
+    const std::size_t _pixelBytes = pixelBytes(header);
+
+    Header _header = header;
+    _header.magic = Magic;
+    _header.version = Version;
+    _header.checksum = hash(reinterpret_cast<const std::uint8_t*>(glyphs), _glyphBytes);
+    _header.checksum = hash(pixels, _pixelBytes, _header.checksum);
+
+    // Write to a temporary file first, so a crash never leaves a half-written entry
+    auto _temporary = _path;
+    _temporary += ".tmp";
+    {
+        std::ofstream _file{ _temporary, std::ios::binary | std::ios::trunc };
+        if (!_file) return false;
+        _file.write(reinterpret_cast<const char*>(&_header), sizeof(Header));
+        _file.write(reinterpret_cast<const char*>(glyphs), _glyphBytes);
+        _file.write(reinterpret_cast<const char*>(pixels), _pixelBytes);
+        if (!_file) return false;
+    }
+
+    std::filesystem::rename(_temporary, _path, _ec);
+    if (_ec) std::filesystem::remove(_temporary, _ec);
+    return !_ec;
+}
\ No newline at end of file
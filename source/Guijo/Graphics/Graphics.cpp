@@ -6,7 +6,7 @@ using namespace Guijo;
 std::map<std::string, Guijo::Font, std::less<>> GraphicsBase::Fonts{};
 
 void GraphicsBase::render() {
-    auto& commands = context.m_Commands;
+    auto& commands = committed().m_Commands;
 
     // Make sure clip is entire window at start
     clip = { 0, 0, windowSize.width(), windowSize.height() };
@@ -15,13 +15,17 @@ void GraphicsBase::render() {
     runCommand(_clip);
     runCommand(_vp);
 
-    for (auto& command : commands) {
-        runCommand(command,
+    for (resume = 0; resume < commands.size();) {
+        runCommand(commands[resume++],
             std::make_index_sequence<
             static_cast<std::size_t>(Commands::Amount)>{});
     }
-    context.memPool.reset();
-    commands.clear();
+}
+
+void GraphicsBase::commit() {
+    recording = 1 - recording;
+    context().m_Commands.clear(); // Commands of the frame before, rendered or replaced
+    context().memPool.reset();
 }
 
 void GraphicsBase::dimensions(const Dimensions<float>& dims) {
@@ -49,6 +53,7 @@ void GraphicsBase::runCommand(Command<FontSize>& v) {
 }
 
 void GraphicsBase::runCommand(Command<SetFont>& v) {
+    auto _lock = Font::lock(); // Layout may be measuring text meanwhile
     auto _it = Fonts.find(v.font);
     if (_it != Fonts.end())
         currentFont = &_it->second;
@@ -63,7 +68,8 @@ void GraphicsBase::runCommand(Command<TextAlign>& v) {
 }
 
 void GraphicsBase::runCommand(Command<Translate>& v) {
-    matrix = glm::translate(matrix, glm::vec3(v.translate.x(), v.translate.y(), 0));
+    // The matrix works in flipped coordinates, like the commands it moves
+    matrix = glm::translate(matrix, glm::vec3(v.translate.x(), -v.translate.y(), 0));
     viewProjection = projection * matrix;
 }
 
@@ -72,9 +78,9 @@ void GraphicsBase::runCommand(Command<PushMatrix>&) {
 }
 
 void GraphicsBase::runCommand(Command<PopMatrix>&) {
-    if (matrixStack.size() > 1) {
+    if (!matrixStack.empty()) {
         matrix = matrixStack.top();
         matrixStack.pop();
         viewProjection = projection * matrix;
     }
-}
+}
\ No newline at end of file
@@ -88,6 +88,14 @@ void Graphics::createBuffers() {
     generate(_cornered, rect);
     generate(_cornered, triangle);
     generate(_cornered, text);
+
+    // Text is drawn instanced, 1 instance per glyph: x, y, layer, bearing
+    glBindVertexArray(text.vao);
+    glGenBuffers(1, &textInstances);
+    glBindBuffer(GL_ARRAY_BUFFER, textInstances);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TextRun::Glyph), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
 }
 
 void Graphics::prepare() {
@@ -98,6 +106,12 @@ void Graphics::prepare() {
 
     glClear(GL_COLOR_BUFFER_BIT);
     glClearColor(0, 0, 0, 0);
+
+    // Layers the last render didn't draw belong to objects that are gone
+    for (auto _it = layers.begin(); _it != layers.end();) {
+        if (std::exchange(_it->second.used, false)) ++_it;
+        else release(_it->second), _it = layers.erase(_it);
+    }
 }
 
 void Graphics::swapBuffers() {
@@ -108,6 +122,12 @@ void Graphics::prepare() {}
 #endif
 
 Graphics::~Graphics() {
+    if (!layers.empty()) { // Layer textures are shared with the other contexts
+        wglMakeCurrent(m_Device, m_Context);
+        current = m_Context;
+        for (auto& [_id, _layer] : layers) release(_layer);
+    }
+
     if (m_Context == current)
         wglMakeCurrent(m_Device, nullptr);
     wglDeleteContext(m_Context);
@@ -124,7 +144,7 @@ void Graphics::runCommand(Command<Clip>& v) {
     };
     _clip = _clip.overlap(clip);
     clip = _clip;
-    glScissor(clip.x(), clip.y(), clip.width(), clip.height());
+    scissor();
 }
 
 void Graphics::runCommand(Command<PushClip>&) {
@@ -139,7 +159,7 @@ void Graphics::runCommand(Command<PopClip>&) {
         Dimensions _clip = clipStack.top();
         clipStack.pop();
         clip = _clip;
-        glScissor(clip.x(), clip.y(), clip.width(), clip.height());
+        scissor();
     }
 }
 
@@ -147,11 +167,175 @@ void Graphics::runCommand(Command<ClearClip>&) {
     glDisable(GL_SCISSOR_TEST);
 }
 
+void Graphics::scissor() {
+    glScissor(clip.x() - origin.x(), clip.y() - origin.y(), clip.width(), clip.height());
+}
+
+void Graphics::blending() {
+    // Layers keep premultiplied colors, so they can be blended again
+    if (targets.empty() || !targets.back().layer) glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    else glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Graphics::release(Layer& layer) {
+    glDeleteFramebuffers(2, layer.framebuffers); // Names of 0 are ignored
+    glDeleteTextures(2, layer.textures);
+}
+
+void Graphics::runCommand(Command<PushLayer>& v) {
+    // Same pixels a clip to the area would get, as far as they're in the window
+    v.area.y(windowSize.height() - v.area.y() - v.area.height()); // Flip y
+    Dimensions<float> _area = {
+        std::ceil((v.area.x() + matrix[3][0]) / scaling),
+        std::ceil((v.area.y() + matrix[3][1]) / scaling),
+        std::ceil(v.area.width() / scaling),
+        std::ceil(v.area.height() / scaling)
+    };
+    const float _width = std::floor(windowSize.width() / scaling);
+    const float _height = std::floor(windowSize.height() / scaling);
+    _area = _area.overlap({ 0, 0, _width, _height });
+
+    // Scroll offsets animate and drag by fractions of a pixel, but kept
+    // pixels can only move by whole ones. Contents are drawn at the offset
+    // rounded to device pixels, so scrolling moves them instead of drawing.
+    v.scrolled = {
+        std::round(v.scrolled.x() / scaling) * scaling,
+        std::round(v.scrolled.y() / scaling) * scaling
+    };
+
+    // Contents are drawn scrolled, popping the layer undoes it
+    Command<PushMatrix> _push{};
+    Command<Translate> _translate{ v.scrolled * -1 };
+    GraphicsBase::runCommand(_push);
+    GraphicsBase::runCommand(_translate);
+
+    if (_area.width() <= 0 || _area.height() <= 0) { // Nothing to draw
+        targets.push_back({ nullptr, clip });
+        resume += v.commands;
+        return;
+    }
+
+    auto& _layer = layers[v.id];
+    _layer.used = true;
+    targets.push_back({ &_layer, clip });
+
+    if (_layer.area.width() != _area.width() || _layer.area.height() != _area.height()) {
+        release(_layer);
+        _layer = { .used = true };
+        glGenTextures(2, _layer.textures);
+        glGenFramebuffers(2, _layer.framebuffers);
+        for (std::size_t _i = 0; _i < 2; ++_i) {
+            glBindTexture(GL_TEXTURE_2D, _layer.textures[_i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _area.width(), _area.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, _layer.framebuffers[_i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _layer.textures[_i], 0);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // When nothing but the scroll offset changed, the kept pixels are still
+    // right, moved by this many pixels (y up). Others are drawn again.
+    const Inherited _inherited{ fill, stroke, strokeWeight, fontSize, currentFont, textAlign };
+    const bool _kept = _layer.hash == v.hash && _layer.area == _area && _layer.inherited == _inherited;
+    const float _dx = std::round(_layer.scrolled.x() / scaling) - std::round(v.scrolled.x() / scaling);
+    const float _dy = std::round(v.scrolled.y() / scaling) - std::round(_layer.scrolled.y() / scaling);
+
+    if (_kept && _dx == 0 && _dy == 0) { // Same pixels, only composite them
+        resume += v.commands;
+        return;
+    }
+
+    // Pixels are moved along 1 axis at a time, otherwise the exposed
+    // part isn't a strip that can be drawn at once.
+    const bool _shift = _kept && (_dx == 0 || _dy == 0)
+        && std::abs(_dx) < _area.width() && std::abs(_dy) < _area.height();
+
+    const std::size_t _back = 1 - _layer.front;
+    Dimensions<float> _exposed = _area;
+    if (_shift) {
+        const GLint _sx = std::max(-_dx, 0.f), _sy = std::max(-_dy, 0.f);
+        const GLint _tx = std::max(_dx, 0.f), _ty = std::max(_dy, 0.f);
+        const GLint _w = _area.width() - std::abs(_dx), _h = _area.height() - std::abs(_dy);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _layer.framebuffers[_layer.front]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _layer.framebuffers[_back]);
+        glDisable(GL_SCISSOR_TEST); // Blits are clipped too
+        glBlitFramebuffer(_sx, _sy, _sx + _w, _sy + _h, _tx, _ty, _tx + _w, _ty + _h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        if (_dx > 0) _exposed.width(_dx);
+        else if (_dx < 0) _exposed.x(_area.x() + _area.width() + _dx), _exposed.width(-_dx);
+        else if (_dy > 0) _exposed.height(_dy);
+        else _exposed.y(_area.y() + _area.height() + _dy), _exposed.height(-_dy);
+    }
+
+    _layer.front = _back;
+    _layer.area = _area;
+    _layer.scrolled = v.scrolled;
+    _layer.hash = v.hash;
+    _layer.inherited = _inherited;
+
+    // Draw into the layer with the window's coordinates, limited to the exposed part
+    origin = { _area.x(), _area.y() };
+    glBindFramebuffer(GL_FRAMEBUFFER, _layer.framebuffers[_layer.front]);
+    glViewport(-origin.x(), -origin.y(), _width, _height);
+    glEnable(GL_SCISSOR_TEST);
+    clip = _exposed;
+    scissor();
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT); // Only clears the exposed part
+    blending();
+}
+
+void Graphics::runCommand(Command<PopLayer>&) {
+    const Target _target = targets.back();
+    targets.pop_back();
+
+    Command<PopMatrix> _pop{};
+    GraphicsBase::runCommand(_pop);
+
+    // Back to the layer or window the layer is in
+    const Layer* _outer = targets.empty() ? nullptr : targets.back().layer;
+    origin = _outer ? Point<float>{ _outer->area.x(), _outer->area.y() } : Point<float>{ 0, 0 };
+    glBindFramebuffer(GL_FRAMEBUFFER, _outer ? _outer->framebuffers[_outer->front] : 0);
+    glViewport(-origin.x(), -origin.y(),
+        std::floor(windowSize.width() / scaling), std::floor(windowSize.height() / scaling));
+    glEnable(GL_SCISSOR_TEST);
+    clip = _target.clip;
+    scissor();
+
+    if (!_target.layer) return;
+
+    static const Shader _shader{
+#include <Guijo/Shaders/LayerVertex.shader>
+#include <Guijo/Shaders/LayerFragment.shader>
+    };
+    static const GLint uf_mvp = _shader.uniform("mvp");
+    static const GLint uf_layer = _shader.uniform("layer");
+
+    if (_shader.use()) rect.bind();
+
+    auto& _area = _target.layer->area;
+    glm::mat4 _model{ 1.0f };
+    _model = glm::translate(_model, glm::vec3{ _area.x() * scaling, _area.y() * scaling, 0.f });
+    _model = glm::scale(_model, glm::vec3{ _area.width() * scaling, _area.height() * scaling, 1 });
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _target.layer->textures[_target.layer->front]);
+    _shader[uf_mvp] = projection * _model;
+    _shader[uf_layer] = 0;
+
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // Colors are premultiplied
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    blending();
+}
+
 void Graphics::runCommand(Command<Viewport>& v) {
     v.viewport.y(windowSize.height() - v.viewport.y() - v.viewport.height()); // Flip y
     glViewport(
-        std::floor(v.viewport.x() / scaling),
-        std::floor(v.viewport.y() / scaling),
+        std::floor(v.viewport.x() / scaling) - origin.x(),
+        std::floor(v.viewport.y() / scaling) - origin.y(),
         std::floor(v.viewport.width() / scaling),
         std::floor(v.viewport.height() / scaling)
     );
@@ -336,74 +520,50 @@ void Graphics::runCommand(Command<Text>& v) {
 
     static const GLint uf_color = _shader.uniform("color");
     static const GLint uf_fontmap = _shader.uniform("fontmap");
-    static const GLint uf_character = _shader.uniform("character");
-    static const GLint uf_dim = _shader.uniform("dim");
+    static const GLint uf_origin = _shader.uniform("origin");
+    static const GLint uf_translate = _shader.uniform("translate");
+    static const GLint uf_projection = _shader.uniform("projection");
+    static const GLint uf_size = _shader.uniform("size");
+    static const GLint uf_scale = _shader.uniform("scale");
 
     // No font selected, so can't render text
     if (!currentFont) return;
 
+    auto _lock = Font::lock(); // Layout may be measuring text meanwhile
+
+    // Shaped run is cached, so only translate it to the pen position
+    auto& _run = TextRuns.get(str, *currentFont, fontSize, textAlign);
+    if (_run.glyphs.empty()) return;
+
     // For text rendering we use a different blend function
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     if (_shader.use()) text.bind();
 
-    // Get the character map from the current font
-    auto& _charMap = currentFont->size(std::round(fontSize));
-
-    // Calculate the total width if we need it.
-    float _totalWidth = 0.0f;
-    if (textAlign & Align::Right || textAlign & Align::CenterX)
-        for (int i = 0; i < str.size(); i++)
-            _totalWidth += _charMap.character(str[i]).advance >> 6;
-    
-    // Bind the 3d texture for this charmap
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, _charMap.texture);
     _shader[uf_color] = fill;
     _shader[uf_fontmap] = 0; // We need to set the texture like this
-
-    // Adjust for non-integer size
-    float _scale = fontSize / std::round(fontSize); 
-    
-    // Adjust position with vertical alignment
-    if (textAlign & Align::Middle) pos.y(pos.y() - _charMap.middle());
-    else if (textAlign & Align::TextBottom) pos.y(pos.y() - _charMap.descender());
-    else if (textAlign & Align::Baseline);
-    else pos.y(pos.y() - (_charMap.ascender() + _charMap.descender()));
-
-    // Adjust position with horizontal alignment
-    if (textAlign & Align::CenterX) pos.x(pos.x() - 0.5 * _totalWidth * _scale);
-    else if (textAlign & Align::Right) pos.x(pos.x() - _totalWidth * _scale);
-
-    // Draw all the characters
-    for (char _c : str) {
-        auto& _ch = _charMap.character(_c);
-
-        // Some characters that shouldn't be drawn
-        constexpr static auto blacklist = [](char _c) {
-            return _c == ' '  || _c == '\f' || _c == '\r'
-                || _c == '\t' || _c == '\v' || _c == '\n';
-        };
-
-        if (!blacklist(_c)) { // If character not in blacklist, draw it
-            float _xpos = std::floor(pos.x() * matrix[0][0] + _ch.bearing.x() * _scale);
-            float _ypos = std::floor(pos.y() - (_ch.size.height() - _ch.bearing.y()) * _scale);
-
-            glm::vec4 _dim{};
-            _dim.x = (_xpos + matrix[3].x) * projection[0].x + projection[3].x;
-            _dim.y = (_ypos + matrix[3].y) * projection[1].y + projection[3].y;
-            _dim.z = fontSize * projection[0].x;
-            _dim.w = fontSize * projection[1].y;
-
-            _shader[uf_dim] = _dim;
-            _shader[uf_character] = _c;
-
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-        }
-
-        pos.x(pos.x() + (_ch.advance >> 6) * _scale);
+    _shader[uf_origin] = glm::vec2{ pos.x() * matrix[0][0], pos.y() };
+    _shader[uf_translate] = glm::vec2{ matrix[3].x, matrix[3].y };
+    _shader[uf_projection] = glm::vec4{ projection[0].x, projection[1].y, projection[3].x, projection[3].y };
+    _shader[uf_size] = glm::vec2{ fontSize, fontSize };
+    _shader[uf_scale] = matrix[0][0]; // Pen advances scale horizontally, like the origin
+
+    glBindBuffer(GL_ARRAY_BUFFER, textInstances);
+    glBufferData(GL_ARRAY_BUFFER, _run.glyphs.size() * sizeof(TextRun::Glyph), 
+        _run.glyphs.data(), GL_STREAM_DRAW);
+
+    // Submit the glyphs of every page in a single draw call, pages
+    // can come from any font in the fallback chain.
+    for (auto& _batch : _run.batches) {
+        auto& _charMap = _batch.font->size(std::round(fontSize));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _charMap.texture(_charMap.page(_batch.page)));
+        // Base instances need GL 4.2, so point the instance data at the batch instead
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(TextRun::Glyph),
+            reinterpret_cast<void*>(_batch.first * sizeof(TextRun::Glyph)));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, _batch.count);
     }
 
     glBindTexture(GL_TEXTURE_2D, 0);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    blending();
 }
 #endif
\ No newline at end of file
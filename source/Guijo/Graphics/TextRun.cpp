@@ -0,0 +1,175 @@
+#include "Guijo/Graphics/TextRun.hpp"
+#include "Guijo/Utils/Utf8.hpp"
+#include <numeric>
+
+using namespace Guijo;
+
+std::size_t TextRunCache::hash(std::string_view text, Font* font, std::size_t generation, float size, Alignment align) {
+    std::size_t _hash = std::hash<std::string_view>{}(text);
+    const auto _combine = [&](std::size_t v) {
+        _hash ^= v + 0x9e3779b97f4a7c15ull + (_hash << 6) + (_hash >> 2);
+    };
+    _combine(std::hash<Font*>{}(font));
+    _combine(generation);
+    _combine(std::hash<float>{}(size));
+    _combine(static_cast<std::size_t>(align));
+    return _hash;
+}
+
+const TextRun& TextRunCache::get(std::string_view text, Font& font, float size, Alignment align) {
+    const std::size_t _generation = font.generation();
+    const std::size_t _hash = hash(text, &font, _generation, size, align);
+
+    auto _it = m_Lookup.find(_hash);
+    if (_it != m_Lookup.end()) {
+        auto& _entry = *_it->second;
+        if (_entry.font == &font && _entry.generation == _generation && _entry.size == size
+            && _entry.align == align && _entry.text == text) {
+            ++m_Statistics.hits; // Move to front, it's most recently used now
+            m_Entries.splice(m_Entries.begin(), m_Entries, _it->second);
+            return _entry.run;
+        }
+        erase(_it->second); // Hash collision, replace the old run
+    }
+
+    ++m_Statistics.misses;
+    auto& _entry = m_Entries.emplace_front(Entry{
+        std::string{ text }, &font, _generation, size, align, _hash });
+    shape(_entry);
+    _entry.bytes = sizeof(Entry) + _entry.text.capacity()
+        + _entry.run.glyphs.capacity() * sizeof(TextRun::Glyph)
+        + _entry.run.batches.capacity() * sizeof(TextRun::Batch);
+    m_Lookup[_hash] = m_Entries.begin();
+    m_Statistics.bytes += _entry.bytes;
+    m_Statistics.entries = m_Entries.size();
+
+    evict();
+    return m_Entries.front().run;
+}
+
+void TextRunCache::shape(Entry& entry) {
+    auto& [text, font, generation, size, align, hash, bytes, run] = entry;
+
+    // Get the character map from the font
+    const int _size = std::round(size);
+    auto& _charMap = font->size(_size);
+
+    // Adjust for non-integer size
+    float _scale = size / std::round(size);
+
+    // Decode once, the text is iterated twice
+    std::u32string _codepoints;
+    Utf8::decode(text, _codepoints);
+
+    // Pick the font of every codepoint from the coverage of the fallback
+    // chain, the character maps are looked up once per font.
+    auto& _chain = font->chain();
+    std::vector<Font::CharMap*> _charMaps(_chain.size(), nullptr);
+    _charMaps[0] = &_charMap;
+    std::vector<std::uint8_t> _fonts(_codepoints.size());
+    for (std::size_t _i = 0; _i < _codepoints.size(); ++_i) {
+        const std::size_t _font = font->select(_codepoints[_i]);
+        if (!_charMaps[_font]) _charMaps[_font] = &_chain[_font]->size(_size);
+        _fonts[_i] = static_cast<std::uint8_t>(_font);
+    }
+
+    // Calculate the total width if we need it.
+    float _totalWidth = 0.0f;
+    for (std::size_t _i = 0; _i < _codepoints.size(); ++_i)
+        _totalWidth += _charMaps[_fonts[_i]]->character(_codepoints[_i]).advance >> 6;
+    run.width = _totalWidth * _scale;
+
+    // Offset from pen origin due to vertical alignment
+    float _y = 0;
+    if (align & Align::Middle) _y = -_charMap.middle();
+    else if (align & Align::TextBottom) _y = -_charMap.descender();
+    else if (align & Align::Baseline);
+    else _y = -(_charMap.ascender() + _charMap.descender());
+
+    // Offset from pen origin due to horizontal alignment
+    float _x = 0;
+    if (align & Align::CenterX) _x = -0.5 * run.width;
+    else if (align & Align::Right) _x = -run.width;
+
+    // Font index in the high bits, page in the low bits
+    std::vector<std::uint64_t> _pages;
+    run.glyphs.reserve(_codepoints.size());
+    _pages.reserve(_codepoints.size());
+    for (std::size_t _i = 0; _i < _codepoints.size(); ++_i) {
+        const char32_t _c = _codepoints[_i];
+        auto& _ch = _charMaps[_fonts[_i]]->character(_c);
+
+        // Some characters that shouldn't be drawn
+        constexpr static auto blacklist = [](char32_t _c) {
+            return _c == ' '  || _c == '\f' || _c == '\r'
+                || _c == '\t' || _c == '\v' || _c == '\n';
+        };
+
+        if (!blacklist(_c)) { // If not in blacklist, add glyph
+            run.glyphs.push_back({
+                _x,
+                _y - (_ch.size.height() - _ch.bearing.y()) * _scale,
+                static_cast<float>(_ch.index),
+                _ch.bearing.x() * _scale,
+            });
+            _pages.push_back(static_cast<std::uint64_t>(_fonts[_i]) << 32 | _c / Font::PageSize);
+        }
+
+        _x += (_ch.advance >> 6) * _scale;
+    }
+
+    // Group glyphs by font and page, so every page is a single draw call
+    if (!std::ranges::is_sorted(_pages)) {
+        std::vector<std::size_t> _order(_pages.size());
+        std::iota(_order.begin(), _order.end(), 0);
+        std::ranges::stable_sort(_order, {}, [&](std::size_t i) { return _pages[i]; });
+        std::vector<TextRun::Glyph> _glyphs;
+        std::vector<std::uint64_t> _sorted;
+        _glyphs.reserve(_order.size());
+        _sorted.reserve(_order.size());
+        for (std::size_t _i : _order) {
+            _glyphs.push_back(run.glyphs[_i]);
+            _sorted.push_back(_pages[_i]);
+        }
+        run.glyphs = std::move(_glyphs);
+        _pages = std::move(_sorted);
+    }
+
+    for (std::uint32_t _i = 0; _i < _pages.size(); ++_i) {
+        if (_i == 0 || _pages[_i - 1] != _pages[_i])
+            run.batches.push_back({ _chain[_pages[_i] >> 32], 
+                static_cast<char32_t>(_pages[_i] & 0xFFFFFFFF), _i, 0 });
+        ++run.batches.back().count;
+    }
+
+    run.glyphs.shrink_to_fit();
+    run.batches.shrink_to_fit();
+}
+
+void TextRunCache::erase(std::list<Entry>::iterator it) {
+    m_Statistics.bytes -= it->bytes;
+    m_Lookup.erase(it->hash);
+    m_Entries.erase(it);
+    m_Statistics.entries = m_Entries.size();
+}
+
+void TextRunCache::evict() {
+    // Always keep the most recent run, even if it alone exceeds the budget
+    while (m_Statistics.bytes > budget && m_Entries.size() > 1) {
+        erase(std::prev(m_Entries.end()));
+        ++m_Statistics.evictions;
+    }
+}
+
+void TextRunCache::clear() {
+    m_Entries.clear();
+    m_Lookup.clear();
+    m_Statistics.bytes = 0;
+    m_Statistics.entries = 0;
+}
+
+void TextRunCache::resetStatistics() {
+    m_Statistics.hits = 0;
+    m_Statistics.misses = 0;
+    m_Statistics.evictions = 0;
+}
\ No newline at end of file
@@ -25,5 +25,6 @@ State EventReceiver::set(StateId v, State value) {
 }
 
 void EventReceiver::handle(const Event& e) {
-    for (auto& _h : m_EventHandlers) _h->handle(*this, e);
-}
+    if (e.type() >= m_EventHandlers.size()) return;
+    for (auto& _h : m_EventHandlers[e.type()]) _h->handle(e);
+}
\ No newline at end of file
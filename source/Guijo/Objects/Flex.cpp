@@ -1,111 +1,327 @@
 #include "Guijo/Objects/Flex.hpp"
 #include "Guijo/Objects/Object.hpp"
 #include "Guijo/Objects/Scrollbar.hpp"
+#include "Guijo/Utils/ThreadPool.hpp"
+#include "Guijo/Utils/PrefixSums.hpp"
 
 using namespace Guijo;
 using namespace Flex;
 
+namespace {
+    ThreadPool& pool() {
+        static ThreadPool _pool;
+        return _pool;
+    }
+
+    // Parallel subtrees may mark the same ancestors dirty at the same time
+    std::mutex invalidation;
+
+    enum class Flexing { Shrink, Grow }; // Whether a line is too long or has space left
+
+    // Flex item while resolving flexible lengths, with its constraints
+    // resolved once instead of in every iteration.
+    struct Flexible {
+        Box* box;
+        float base;      // flex-base-size
+        float outerBase; // flex-base-size + margin
+        float margin;
+        float factor;    // flex-grow or flex-shrink
+        float scaled;    // factor, scaled by the flex-base-size when shrinking
+        float min;       // 0 when not constrained, no negative sizes
+        float max;       // infinite when not constrained
+        float target = 0;
+        bool frozen = false;
+        double minAt = 0; // Free space per scaled factor below which the min is violated
+        double maxAt = 0; // Free space per scaled factor above which the max is violated
+        std::uint32_t minRank = 0; // Position in the sorted orders
+        std::uint32_t maxRank = 0;
+    };
+
+    // Scratch space of flexible length resolution, reused by every line
+    struct Resolution {
+        std::vector<Flexible> items;
+        std::vector<std::uint32_t> active; // Items that weren't frozen yet
+        std::vector<std::uint32_t> byMin;  // Items, highest minAt first
+        std::vector<std::uint32_t> byMax;  // Items, lowest maxAt first
+        PrefixSums minSpace, minScaled; // min - base and scaled factor of unfrozen items, in byMin order
+        PrefixSums maxSpace, maxScaled; // max - base and scaled factor of unfrozen items, in byMax order
+    };
+
+    thread_local Resolution resolution;
+
+    // Values of a box that neither it nor its class sets, in store order
+    const std::array<Value, NodeStore::Fields>& defaults() {
+        static const std::array<Value, NodeStore::Fields> _defaults{
+            Value::Auto, Value::Auto, Value::Auto, Value::Auto, // overflow, size
+            Value::None, Value::None, Value::None, Value::None, // max, min
+            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,             // margin, padding
+            Static, Row, Value::Auto, 0.f, 1.f, NoWrap,          // position, flex
+            Start, Stretch, Stretch, Value::Auto,                // justify, align
+        };
+        return _defaults;
+    }
+}
+
 CalcValue CalcValue::decode(Box& obj, CalcValue pval) {
     switch (type) {
     // Normal/Pixels is just the value
-    case Value::Pixels: return { type, value };
+    case Value::Type::Pixels: return { type, value };
     // Percent uses parent size
-    case Value::Percent: // If pval is percent or indefinite, we don't know...
-        if (!pval.is(Value::Percent) && pval.definite()) return { Value::Pixels, pval.value * value / 100.f };
-        else return { Value::Infinite };
+    case Value::Type::Percent: // If pval is percent or indefinite, we don't know...
+        if (!pval.is(Value::Type::Percent) && pval.definite()) return { Value::Type::Pixels, pval.value * value / 100.f };
+        else return { Value::Type::Infinite };
     // View width and height are percent of window size
-    case Value::ViewWidth: return { Value::Pixels, obj.windowSize[0] * value / 100.f };
-    case Value::ViewHeight: return { Value::Pixels, obj.windowSize[1] * value / 100.f };
+    case Value::Type::ViewWidth: return { Value::Type::Pixels, obj.windowSize[0] * value / 100.f };
+    case Value::Type::ViewHeight: return { Value::Type::Pixels, obj.windowSize[1] * value / 100.f };
     // Remain at current value if we can't decode
     default: return *this;
     }
 }
 
-void Value::classAssign(const Value& v) {
-    if (v.type != Unset) {
-        type = v.type;
-        if (v.type == Enum) enumValue = v.enumValue;
-        else Parent::operator=(v.m_Default);
+void Value::invalidateOwner() {
+    owner->stale = true;
+    owner->invalidate();
+}
+
+bool Value::follow(const Value& v, const EventReceiver* states, StateFind changed) {
+    const auto _state = [&](StateId id) -> State {
+        return id == changed.id ? changed.value : states ? states->get(id) : 0;
+    };
+
+    // First matching link wins, same as our own links
+    const float* _goal = v.type != Unset ? &v.m_Default : &m_Default;
+    for (auto& [_link, _value] : v.m_Values) {
+        if (_link.match({ _link.id, _state(_link.id) }) == StateLink::Find::Match) {
+            _goal = &_value;
+            break;
+        }
     }
-    for (auto& i : v.m_Values)
-        m_Values.push_back(i);
 
     if (v.m_Curve != Curves::linear) m_Curve = v.m_Curve;
     if (v.m_Time != 0) m_Time = v.m_Time;
+    if (goal() == *_goal) return false;
+    Animated::assign(*_goal); // Transitions like our own value, without overriding the class
+    return true;
+}
+
+std::uint32_t NodeStore::allocate() {
+    if (!m_Free.empty()) {
+        const std::uint32_t _node = m_Free.back();
+        m_Free.pop_back();
+        return _node;
+    }
+    for (auto& _field : m_Fields) _field.emplace_back();
+    return static_cast<std::uint32_t>(m_Fields[0].size() - 1);
+}
+
+void NodeStore::release(std::uint32_t node) {
+    m_Free.push_back(node);
+}
+
+CalcValue Property::get() const {
+    return box->current(field);
+}
+
+Value& Property::own() {
+    return box->override(field);
+}
+
+Value& Property::animated() {
+    return box->emplace(field);
+}
+
+Box::Box() : node(store.allocate()) {}
+
+Box::~Box() {
+    store.release(node);
+}
+
+template<class Style>
+auto Box::fields(Style& s) {
+    return std::array{
+        &s.overflow.x, &s.overflow.y, &s.size.width, &s.size.height, 
+        &s.max.width, &s.max.height, &s.min.width, &s.min.height, 
+        &s.margin.left, &s.margin.top, &s.margin.right, &s.margin.bottom, 
+        &s.padding.left, &s.padding.top, &s.padding.right, &s.padding.bottom, 
+        &s.position, &s.flex.direction, &s.flex.basis, &s.flex.grow, &s.flex.shrink, &s.flex.wrap, 
+        &s.justify, &s.align.content, &s.align.items, &s.align.self,
+    };
+}
+
+Value* Box::find(Field field) {
+    for (auto& [_field, _value] : values) if (_field == field) return &_value;
+    return nullptr;
+}
+
+const Value* Box::find(Field field) const {
+    for (auto& [_field, _value] : values) if (_field == field) return &_value;
+    return nullptr;
+}
+
+Value& Box::emplace(Field field) {
+    if (Value* _value = find(field)) return *_value;
+    values.emplace_back(field, defaults()[static_cast<std::size_t>(field)]);
+    for (auto& [_field, _value] : values) _value.owner = this; // Copies aren't owned
+    return values.back().second;
+}
+
+Value& Box::override(Field field) {
+    Value& _value = emplace(field);
+    const std::uint32_t _bit = 1u << static_cast<std::size_t>(field);
+    if (!(overrides & _bit)) { // Even when the value doesn't change, the class no longer applies
+        overrides |= _bit;
+        stale = true;
+        invalidate();
+    }
+    return _value;
+}
+
+CalcValue Box::current(Field field) const {
+    const std::size_t _i = static_cast<std::size_t>(field);
+    const Value* _own = find(field);
+    const Value* _class = styleClass && (classed & ~overrides) >> _i & 1 
+        ? fields(*styleClass)[_i] : nullptr;
+    if (_class && _class->type == Value::Type::Unset) _class = nullptr; // Only links to states
+    // Our value carries the class's number, so it can transition
+    const Value& _number = _own ? *_own : _class ? *_class : defaults()[_i];
+    const Value& _typed = _class ? *_class : _number;
+    return _typed.type == Value::Type::Enum
+        ? CalcValue{ Value::Type::Enum, _typed.enumValue }
+        : CalcValue{ _typed.type, _number.get() };
 }
 
-CalcValue Margin::get(std::size_t i) {
-    switch (i) {
-    case 0: return { left.getType(), left.get() };
-    case 1: return { top.getType(), top.get() };;
-    case 2: return { right.getType(), right.get() };;
-    default: return { bottom.getType(), bottom.get() };;
+void Box::invalidate() {
+    std::lock_guard _lock{ invalidation };
+    // Walk all the way up, ancestors need to lay out this box again. Hidden
+    // boxes aren't part of their parent's layout, so stop there.
+    for (Box* _box = this; _box != nullptr; _box = _box->parent) {
+        _box->invalidated = true;
+        for (auto& _memo : _box->memo) _memo.valid = false;
+        if (_box->hidden) break;
     }
 }
 
-CalcValue Flex::Size::get(std::size_t i) {
-    switch (i) {
-    case 0: return { width.getType(), width.get() };
-    default: return { height.getType(), height.get() };
+void Box::remeasure() {
+    for (auto& _measured : measured) _measured.valid = false;
+    invalidate();
+}
+
+void Box::dirty() {
+    std::lock_guard _lock{ invalidation };
+    for (Box* _box = this; _box != nullptr; _box = _box->parent) {
+        _box->invalidated = true;
+        if (_box->hidden) break;
+    }
+}
+
+bool Box::Input::operator==(const Input& o) const {
+    const auto _equal = [](const Vec2<CalcValue>& a, const Vec2<CalcValue>& b) {
+        return a[0].type == b[0].type && a[0].value == b[0].value
+            && a[1].type == b[1].type && a[1].value == b[1].value;
+    };
+    return _equal(parentSize, o.parentSize) && _equal(usedSize, o.usedSize)
+        && windowSize == o.windowSize && dimensions == o.dimensions 
+        && parentUse == o.parentUse && parentDirection == o.parentDirection && use == o.use
+        && scrollbarX == o.scrollbarX && scrollbarY == o.scrollbarY && sizing == o.sizing;
+}
+
+void Box::resolve() {
+    // Animating values don't notify us, so they're resolved every time
+    if (!stale && !moving) return;
+    stale = moving = relative = false;
+    for (std::size_t _i = 0; _i < NodeStore::Fields; ++_i) {
+        const CalcValue _value = current(static_cast<Field>(_i));
+        store[static_cast<Field>(_i)][node] = _value;
+        relative |= _value.is(Value::Type::Percent);
+    }
+    for (auto& [_field, _value] : values) moving |= _value.animating();
+}
+
+void Box::update(StateId id, State value) {
+    if (id == Guijo::Visible && hidden != (value == 0)) {
+        hidden = value == 0;
+        // Only the parent's items changed, our own results still hold
+        if (parent) parent->invalidate();
     }
+    for (auto& [_field, _value] : values) _value.update(id, value);
+    if (classLinked & ~overrides) restyle({ id, value });
 }
 
-CalcValue Flex::Point::get(std::size_t i) {
-    switch (i) {
-    case 0: return { x.getType(), x.get() };
-    default: return { y.getType(), y.get() };
+std::vector<Pointer<Object>>& Box::items(Object& self) {
+    auto& _objects = self.objects();
+    if (std::ranges::none_of(_objects, [](auto& o) { return o->box.hidden; })) return _objects;
+    shown.clear();
+    for (auto& _o : _objects) if (!_o->box.hidden) shown.push_back(_o);
+    return shown;
+}
+
+void Box::restyle(StateFind changed) {
+    std::array<const Value*, NodeStore::Fields> _class{};
+    if (styleClass) _class = fields(std::as_const(*styleClass));
+    bool _changed = false;
+    for (std::size_t _i = 0; _i < _class.size(); ++_i) {
+        if (overrides >> _i & 1) continue; // Our own value, already current
+        const Field _field = static_cast<Field>(_i);
+        Value* _value = find(_field);
+        if (_class[_i] && (_class[_i]->type != Value::Type::Unset || !_class[_i]->m_Values.empty())) {
+            // Constants are read from the class, only what can move needs our own value
+            if (!_value && (!_class[_i]->m_Values.empty() || _class[_i]->m_Time != 0)) _value = &emplace(_field);
+            if (_value) _changed |= _value->follow(*_class[_i], receiver, changed);
+            classed |= 1u << _i;
+        } else if (classed >> _i & 1) { // Class no longer sets it, back to our own value
+            if (_value) _value->Animated::assign(_value->m_Default);
+            classed &= ~(1u << _i);
+            _changed = true;
+        }
+    }
+
+    if (_changed) {
+        stale = true;
+        invalidate();
     }
 }
 
 void Box::operator=(const Class& v) {
-    overflow.x.classAssign(v.overflow.x);
-    overflow.y.classAssign(v.overflow.y);
-    size.width.classAssign(v.size.width);
-    size.height.classAssign(v.size.height);
-    min.width.classAssign(v.min.width);
-    min.height.classAssign(v.min.height);
-    max.width.classAssign(v.max.width);
-    max.height.classAssign(v.max.height);
-    margin.left.classAssign(v.margin.left);
-    margin.top.classAssign(v.margin.top);
-    margin.right.classAssign(v.margin.right);
-    margin.bottom.classAssign(v.margin.bottom);
-    padding.left.classAssign(v.padding.left);
-    padding.top.classAssign(v.padding.top);
-    padding.right.classAssign(v.padding.right);
-    padding.bottom.classAssign(v.padding.bottom);
-    position.classAssign(v.position);
-    flex.direction.classAssign(v.flex.direction);
-    flex.basis.classAssign(v.flex.basis);
-    flex.grow.classAssign(v.flex.grow);
-    flex.shrink.classAssign(v.flex.shrink);
-    flex.wrap.classAssign(v.flex.wrap);
-    justify.classAssign(v.justify);
-    align.content.classAssign(v.align.content);
-    align.items.classAssign(v.align.items);
-    align.self.classAssign(v.align.self);
+    // Copy into a class only we use, so restyling doesn't allocate again
+    Pointer<Class> _class = std::move(styleClass);
+    if (_class && _class->ref == 1) *_class = v;
+    else _class = new Class{ v };
+    operator=(std::move(_class));
+}
+
+void Box::operator=(Pointer<Class> v) {
+    styleClass = std::move(v);
+    classLinked = 0;
+    if (styleClass) {
+        auto _class = fields(std::as_const(*styleClass));
+        for (std::size_t _i = 0; _i < _class.size(); ++_i)
+            if (!_class[_i]->m_Values.empty()) classLinked |= 1u << _i;
+    }
+    restyle();
+    stale = true; // Types and enums come from the class too
+    invalidate();
 }
 
 std::size_t Box::flowDirection() {
-    return flex.direction == Direction::Column
-        || flex.direction == Direction::ColumnReverse;
+    const CalcValue _direction = style(Field::FlexDirection);
+    return _direction == Direction::Column || _direction == Direction::ColumnReverse;
 }
 
 void Box::calcAvailableSize() {
     auto _checkDim = [this](std::size_t dim) -> CalcValue {
         CalcValue _value{};
         CalcValue _parent = parent->innerAvailableSize[dim];
-        CalcValue _size = size.get(dim).decode(*this, _parent);
-        CalcValue _min = min.get(dim).decode(*this, _parent);
-        CalcValue _max = max.get(dim).decode(*this, _parent);
-        CalcValue _margin1 = margin.get(dim).decode(*this, _parent);
-        CalcValue _margin2 = margin.get(dim + 2).decode(*this, _parent);
+        CalcValue _size = style(Field::Width, dim).decode(*this, _parent);
+        CalcValue _min = style(Field::MinWidth, dim).decode(*this, _parent);
+        CalcValue _max = style(Field::MaxWidth, dim).decode(*this, _parent);
+        CalcValue _margin1 = style(Field::MarginLeft, dim).decode(*this, _parent);
+        CalcValue _margin2 = style(Field::MarginLeft, dim + 2).decode(*this, _parent);
 
         // If used size is definite, content box has been defined for that dimension, so use that
         if (parent->use && usedSize[dim].definite()) _value = usedSize[dim];
         else if (parent->use && usedSize[dim].definite()) _value = usedSize[dim];
         else if (_size.definite()) _value = _size;
-        else return { Value::Infinite }; // Fallback to infinite size
+        else return { Value::Type::Infinite }; // Fallback to infinite size
 
         // Constrain size to min/max if definite
         if (_min.definite()) _value = std::max(_value.value, _min.value);
@@ -118,16 +334,16 @@ void Box::calcAvailableSize() {
     else availableSize = { _checkDim(0), _checkDim(1) };
 
     innerAvailableSize = { 
-        subPadding(availableSize[0], 0, parent ? parent->innerAvailableSize[0] : Value::Infinite),
-        subPadding(availableSize[1], 0, parent ? parent->innerAvailableSize[1] : Value::Infinite)
+        subPadding(availableSize[0], 0, parent ? parent->innerAvailableSize[0] : Value::Type::Infinite),
+        subPadding(availableSize[1], 0, parent ? parent->innerAvailableSize[1] : Value::Type::Infinite)
     };
 }
 
 CalcValue Box::addPadding(CalcValue value, std::size_t dim, CalcValue pval) {
     CalcValue _value = value.decode(*this, pval);
     if (!_value.definite()) return value;
-    CalcValue _padding1 = padding.get(dim).decode(*this, pval);
-    CalcValue _padding2 = padding.get(dim + 2).decode(*this, pval);
+    CalcValue _padding1 = style(Field::PaddingLeft, dim).decode(*this, pval);
+    CalcValue _padding2 = style(Field::PaddingLeft, dim + 2).decode(*this, pval);
     if (_padding1.definite()) value = value + _padding1;
     if (_padding2.definite()) value = value + _padding2;
     return value;
@@ -136,8 +352,8 @@ CalcValue Box::addPadding(CalcValue value, std::size_t dim, CalcValue pval) {
 CalcValue Box::addMargin(CalcValue value, std::size_t dim, CalcValue pval) {
     CalcValue _value = value.decode(*this, pval);
     if (!_value.definite()) return value;
-    CalcValue _margin1 = margin.get(dim).decode(*this, pval);
-    CalcValue _margin2 = margin.get(dim + 2).decode(*this, pval);
+    CalcValue _margin1 = style(Field::MarginLeft, dim).decode(*this, pval);
+    CalcValue _margin2 = style(Field::MarginLeft, dim + 2).decode(*this, pval);
     if (_margin1.definite()) value = value + _margin1;
     if (_margin2.definite()) value = value + _margin2;
     return value;
@@ -146,8 +362,8 @@ CalcValue Box::addMargin(CalcValue value, std::size_t dim, CalcValue pval) {
 CalcValue Box::subPadding(CalcValue value, std::size_t dim, CalcValue pval) {
     CalcValue _value = value.decode(*this, pval);
     if (!_value.definite()) return value;
-    CalcValue _padding1 = padding.get(dim).decode(*this, pval);
-    CalcValue _padding2 = padding.get(dim + 2).decode(*this, pval);
+    CalcValue _padding1 = style(Field::PaddingLeft, dim).decode(*this, pval);
+    CalcValue _padding2 = style(Field::PaddingLeft, dim + 2).decode(*this, pval);
     if (_padding1.definite()) value = value - _padding1;
     if (_padding2.definite()) value = value - _padding2;
     return value;
@@ -156,8 +372,8 @@ CalcValue Box::subPadding(CalcValue value, std::size_t dim, CalcValue pval) {
 CalcValue Box::subMargin(CalcValue value, std::size_t dim, CalcValue pval) {
     CalcValue _value = value.decode(*this, pval);
     if (!_value.definite()) return value;
-    CalcValue _margin1 = margin.get(dim).decode(*this, pval);
-    CalcValue _margin2 = margin.get(dim + 2).decode(*this, pval);
+    CalcValue _margin1 = style(Field::MarginLeft, dim).decode(*this, pval);
+    CalcValue _margin2 = style(Field::MarginLeft, dim + 2).decode(*this, pval);
     if (_margin1.definite()) value = value - _margin1;
     if (_margin2.definite()) value = value - _margin2;
     return value;
@@ -173,8 +389,101 @@ CalcValue clamp(Box& self, const CalcValue& pval, CalcValue v, CalcValue min, Ca
     return v;
 }
 
+Box::Input Box::input(Object& self, bool sizing) {
+    // The parent's size is only read through percentages, leaving it out
+    // of the key otherwise lets sizing passes of both parent axes match.
+    return {
+        .parentSize = parent && relative ? parent->innerAvailableSize : Vec2<CalcValue>{},
+        .usedSize = usedSize,
+        .windowSize = windowSize,
+        .dimensions = self.dimensions(),
+        .parentUse = parent && parent->use,
+        .parentDirection = parent ? parent->flowDirection() : 0,
+        .use = use,
+        .scrollbarX = self.scrollbar.x->visible,
+        .scrollbarY = self.scrollbar.y->visible,
+        .sizing = sizing,
+    };
+}
+
+bool Box::restore(const Input& input) {
+    // Nothing in this subtree changed since this pass was calculated with
+    // the same constraints, so the results still hold.
+    for (auto& _memo : memo) {
+        if (!_memo.valid || (_memo.transient && _memo.pass != pass)) continue;
+        if (!(_memo.input == input)) continue;
+        availableSize = _memo.availableSize;
+        innerAvailableSize = _memo.innerAvailableSize;
+        usedSize = _memo.usedSize;
+        ++statistics.hits;
+        return true;
+    }
+    return false;
+}
+
 void Box::format(Object& self, bool sizing) {
-    auto& _items = self.objects();
+    format(self, sizing, nullptr);
+}
+
+void Box::format(Object& self, bool sizing, std::vector<Deferred>* deferred) {
+    if (parent == nullptr && !sizing) ++pass; // New frame
+
+    resolve();
+    const Input _input = input(self, sizing);
+    if (cache && restore(_input)) return;
+
+    // Animating values change every frame, so lay out again next frame. Checked
+    // before layout, so the frame after the animation ends uses the final values.
+    const bool _animating = moving;
+
+    ++statistics.layouts;
+    invalidated = false;
+    if (layout(self) && !sizing) {
+        // Our size is known, placing the items only affects this subtree
+        if (deferred && nodes >= parallelThreshold)
+            return deferred->push_back({ &self, _input, _animating });
+        place(self);
+    }
+    finish(self, _input, _animating);
+}
+
+void Box::finish(Object& self, const Input& input, bool animating) {
+    nodes = 1;
+    for (auto& _i : self.objects()) if (!_i->box.hidden) nodes += _i->box.nodes;
+
+    // Scrollbars that appeared or disappeared change the available size,
+    // so layout again with the new size.
+    if (self.scrollbar.x->visible != input.scrollbarX
+        || self.scrollbar.y->visible != input.scrollbarY) {
+        invalidate();
+        return;
+    }
+
+    // Children may have marked us dirty while animating, then this
+    // result is only valid for the rest of this pass.
+    if (animating) dirty();
+
+    // Items are where the last final pass placed them, restoring an older
+    // one would keep them there. So only the last final pass is kept.
+    if (!input.sizing && nodes > 1) 
+        for (auto& _memo : memo) if (!_memo.input.sizing) _memo.valid = false;
+    memo[memoNext] = { true, invalidated, pass, input, availableSize, innerAvailableSize, usedSize };
+    memoNext = (memoNext + 1) % memo.size();
+}
+
+template<class Items>
+void Box::formatItems(Items& items, bool sizing) {
+    // Sibling subtrees are independent, large ones are formatted in parallel
+    std::vector<Object*> _parallel;
+    for (auto& _item : items) {
+        if (parallel && _item->box.nodes >= parallelThreshold) _parallel.push_back(&*_item);
+        else _item->box.format(*_item, sizing);
+    }
+    pool().run(_parallel.size(), [&](std::size_t i) { _parallel[i]->box.format(*_parallel[i], sizing); });
+}
+
+bool Box::layout(Object& self) {
+    auto& _items = items(self);
 
     // ===================================================
     // Step 1: calculate available size in container
@@ -203,17 +512,24 @@ void Box::format(Object& self, bool sizing) {
         if (parent != nullptr && parent->use) {
             auto _dir = parent->flowDirection() == 1 ? 0 : 1;
             usedSize[_dir] = availableSize[_dir];
+            // Without a size, content fits itself in the size the parent gave us
+            if (!usedSize[_dir].definite() && style(Field::Width, _dir).is(Value::Type::Auto)) {
+                Vec2<CalcValue> _space = usedSize;
+                _space[_dir] = parent->innerAvailableSize[_dir];
+                if (auto _content = measure(self, _space)) {
+                    usedSize[_dir] = clamp(*this, parent->innerAvailableSize[_dir], (*_content)[_dir],
+                        style(Field::MinWidth, _dir), style(Field::MaxWidth, _dir));
+                }
+            }
         } else {
             // All objects need these 2 for their children.
             availableSize = self.size(); 
             innerAvailableSize = self.size();
         }
         // recurse to children after updating parent
-        for (auto& _i : _items) {
-            _i->box.parent = this;
-            _i->box.format(*_i);
-        }
-        return; // and stop here, because no items or not using flex
+        for (auto& _i : _items) _i->box.parent = this;
+        formatItems(_items, false);
+        return false; // and stop here, because no items or not using flex
     }
     
     // Get dimensions
@@ -228,21 +544,27 @@ void Box::format(Object& self, bool sizing) {
     for (auto& _i : _items) {
         auto& _item = _i->box;
         _item.parent = this; // Also update parent
+        _item.resolve();
 
         // Before starting the algorithm, reset to Auto
-        _item.usedSize = { Value::Auto, Value::Auto }; 
+        _item.usedSize = { Value::Type::Auto, Value::Type::Auto }; 
         
         // Calculate the flex-base-size of this item
-        auto _flexBasis = CalcValue{ _item.flex.basis.getType(), 
-            _item.flex.basis}.decode(_item, innerAvailableSize[_main]);
-        auto _size = _item.size.get(_main).decode(_item, innerAvailableSize[_main]);
+        auto _flexBasis = _item.style(Field::FlexBasis).decode(_item, innerAvailableSize[_main]);
+        auto _size = _item.style(Field::Width, _main).decode(_item, innerAvailableSize[_main]);
         if (_flexBasis.definite()) _item.flexBaseSize = _flexBasis;
         else if (_size.definite()) _item.flexBaseSize = _size;
-        else _item.flexBaseSize = 0.f; // fallback to 0
+        else { // Size of the content, or 0 without content
+            Vec2<CalcValue> _space = innerAvailableSize;
+            auto _crossSize = _item.style(Field::Width, _cross).decode(_item, innerAvailableSize[_cross]);
+            if (_crossSize.definite()) _space[_cross] = _crossSize;
+            auto _content = _item.measure(*_i, _space);
+            _item.flexBaseSize = _content ? (*_content)[_main] : 0.f;
+        }
 
         // hypoMainSize is flexBaseSize clamped to min/max values
         _item.hypoSize[_main] = clamp(_item, innerAvailableSize[_main],
-            _item.flexBaseSize, _item.min.get(_main), _item.max.get(_main));
+            _item.flexBaseSize, _item.style(Field::MinWidth, _main), _item.style(Field::MaxWidth, _main));
 
         // outerHypoMainSize is hypoMainSize + margin
         _item.outerHypoSize[_main] = _item.hypoSize[_main];
@@ -263,14 +585,8 @@ void Box::format(Object& self, bool sizing) {
     // Step 3: Collect into lines
     // ===================================================
 
-    struct Line {
-        std::span<Pointer<Object>> items{};
-        float usedSpace = 0;
-        float flexGrow = 0;
-        float flexShrink = 0;
-        float crossSize = 0;
-    };
-    std::vector<Line> _flexLines;
+    auto& _flexLines = lines;
+    _flexLines.clear();
 
     // Get available size in flow direction
     auto _availableSize = 0.f; // Since available size is either definite or 
@@ -279,15 +595,15 @@ void Box::format(Object& self, bool sizing) {
     else _availableSize = std::numeric_limits<float>::infinity(); // infinity
 
     // Single line container, everything in a single line
-    if (flex.wrap == Wrap::NoWrap) {
+    if (style(Field::FlexWrap) == Wrap::NoWrap) {
         float _usedSpace = 0;  // used space
         float _flexGrow = 0;   // sum of flex grow 
         float _flexShrink = 0; // sum of flex shrink
         for (auto& _i : _items) {
             auto& _item = _i->box;
             _usedSpace += _item.outerHypoSize[_main];
-            _flexGrow += _item.flex.grow;
-            _flexShrink += _item.flex.shrink;
+            _flexGrow += _item.style(Field::FlexGrow);
+            _flexShrink += _item.style(Field::FlexShrink);
         }
         _flexLines.push_back({ { _items.begin(), _items.end() },
             _usedSpace, _flexGrow, _flexShrink });
@@ -301,8 +617,8 @@ void Box::format(Object& self, bool sizing) {
         for (auto _i = _items.begin(); _i != _items.end(); ++_i) {
             auto& _item = (*_i)->box;
             float _thisSize = _item.outerHypoSize[_main];
-            float _thisGrow = _item.flex.grow;
-            float _thisShrink = _item.flex.shrink;
+            float _thisGrow = _item.style(Field::FlexGrow);
+            float _thisShrink = _item.style(Field::FlexShrink);
             // Check if going to overflow
             if (!_first && _usedSpace + _thisSize > _availableSize) {
                 // Create line from start to item (item is end of line, so not included!)
@@ -329,139 +645,7 @@ void Box::format(Object& self, bool sizing) {
     // Step 4: Resolve flexible lengths (flex grow/shrink)
     // ===================================================
 
-    for (auto& _line : _flexLines) {
-        // Determine if we're growing or shrinking items
-        enum class Type { Shrink, Grow }; using enum Type;
-        Type _type = _line.usedSpace > _availableSize ? Shrink : Grow;
-        auto _flexFactor = _type == Shrink ? &decltype(flex)::shrink : &decltype(flex)::grow;
-
-        // Freeze items that don't flex, their space usage is target-main-size
-        for (auto& _i : _line.items) {
-            auto& _item = _i->box;
-            _item.freezeSize = false; // initial reset
-            bool _sizing = _type == Shrink // depending on flex type, check less or greater
-                ? _item.flexBaseSize < _item.hypoSize[_main]
-                : _item.flexBaseSize > _item.hypoSize[_main];
-            if (_item.flex.*_flexFactor == 0 || _sizing) {
-                _item.targetSize[_main] = _item.hypoSize[_main];
-                _item.freezeSize = true; // No flexing, so freeze size
-            }
-        }
-
-        // Find the used space in the main axis in this line
-        float _usedOuterFlexSpace = 0;
-        for (auto& _i : _line.items) {
-            auto& _item = _i->box;
-            _usedOuterFlexSpace += _item.freezeSize
-                ? _item.addMargin(_item.targetSize[_main], _main, _availableSize)
-                : _item.outerFlexBaseSize;
-        }
-        float _initialFreeSpace = _availableSize - _usedOuterFlexSpace;
-        
-        std::size_t _safetyCheck = 100; // Safety check, only allow finite amount of
-        while (--_safetyCheck) {        // loops to prevent freezing.
-            // Check if there are flexible items left
-            bool _itemsLeft = false;
-            for (auto& _i : _line.items) {
-                auto& _item = _i->box;
-                if (!_item.freezeSize) {
-                    _itemsLeft = true;
-                    break;
-                }
-            }
-            if (!_itemsLeft) break; // No more left, done
-
-            // Find the sum of all the non-frozen flex-factors, and
-            // the used outer flex space (flex-basis + margin)
-            float _sumFlexFactor = 0;
-            _usedOuterFlexSpace = 0;
-            for (auto& _i : _line.items) {
-                auto& _item = _i->box;
-                if (_item.freezeSize) { // When frozen, use target-size + margin
-                    _usedOuterFlexSpace += _item.addMargin(
-                        _item.targetSize[_main], _main, _availableSize);
-                } else { // Non-frozen: add to flex-factor sum, and use outer-flex-base-size
-                    _sumFlexFactor += _item.flex.*_flexFactor;
-                    _usedOuterFlexSpace += _item.outerFlexBaseSize;
-                }
-            }
-
-            // Calculate the remaining free space
-            float _remainingFreeSpace = _availableSize - _usedOuterFlexSpace;
-            if (_sumFlexFactor < 1.f && _initialFreeSpace * _sumFlexFactor < _remainingFreeSpace) 
-                _remainingFreeSpace = _initialFreeSpace * _sumFlexFactor;
-
-            // Distribute remaining free space proportional to the flex factor
-            if (_remainingFreeSpace != 0) {
-                // Find the sum of the flex factor
-                float _sumFlexFactor = 0;
-                for (auto& _i : _line.items) {
-                    auto& _item = _i->box;
-                    if (_item.freezeSize) continue; // ignore frozen
-                    _sumFlexFactor += _type == Shrink 
-                        ? _item.flex.shrink * _item.flexBaseSize
-                        : _item.flex.grow.get();
-                }
-                // Adjust size of items proportional to their 
-                // flex-factor using the flex-factor sum
-                for (auto& _i : _line.items) {
-                    auto& _item = _i->box;
-                    if (_item.freezeSize) continue; // ignore frozen
-                    if (_type == Shrink) {
-                        float _scaledFlexFactor = _item.flex.shrink * _item.flexBaseSize;
-                        float _ratioFlexFactor = _scaledFlexFactor / _sumFlexFactor;
-                        _item.targetSize[_main] = _item.flexBaseSize -
-                            (std::abs(_remainingFreeSpace) * _ratioFlexFactor);
-                    } else {
-                        float _ratioFlexFactor = _item.flex.grow / _sumFlexFactor;
-                        _item.targetSize[_main] = _item.flexBaseSize +
-                            _remainingFreeSpace * _ratioFlexFactor;
-                    }
-                }
-            }
-
-            // Fix min/max violations
-            float _totalViolation = 0;
-            for (auto& _i : _line.items) {
-                auto& _item = _i->box;
-                if (_item.freezeSize) continue; // ignore frozen
-                // test for min-violation
-                if (_item.min.get(_main).definite()) {
-                    auto _min = _item.min.get(_main).decode(_item, _availableSize);
-                    if (_item.targetSize[_main] < _min) {
-                        _totalViolation += _min - _item.targetSize[_main];
-                        _item.violationType = false;
-                        _item.targetSize[_main] = _min;
-                    }
-                } else { // if not min-constrained, floor at 0 (no negative sizes)
-                    if (_item.targetSize[_main] < 0) {
-                        _totalViolation -= _item.targetSize[_main];
-                        _item.violationType = false;
-                        _item.targetSize[_main] = 0;
-                    }
-                }
-                // test for max-violation
-                if (_item.max.get(_main).definite()) {
-                    auto _max = _item.max.get(_main).decode(_item, _availableSize);
-                    if (_item.targetSize[_main] > _max) {
-                        _totalViolation += _max - _item.targetSize[_main];
-                        _item.violationType = true;
-                        _item.targetSize[_main] = _max;
-                    }
-                }
-            }
-
-            for (auto& _i : _line.items) {
-                auto& _item = _i->box;
-                if (_item.freezeSize) continue; // ignore frozen
-                // Freeze items according to violations
-                if (_totalViolation == 0 // No violations
-                    || _totalViolation > 0 && _item.violationType == false // min-violation
-                    || _totalViolation < 0 && _item.violationType == true) // max-violation
-                    _item.freezeSize = true;
-            }
-        }
-    }
+    for (auto& _line : _flexLines) resolveFlexibleLengths(_line, _main, _availableSize);
 
     // ===================================================
     // Step 5: Cross Size Determination
@@ -469,12 +653,12 @@ void Box::format(Object& self, bool sizing) {
     
     // In order for us to be able to calculate the cross size
     // we need to know the layouts of the items
+    // Set usedSize in main axis to target size, in recurse, this
+    // usedSize will be used for available space
+    for (auto& _i : _items) _i->box.usedSize[_main] = _i->box.targetSize[_main];
+    formatItems(_items, true);
     for (auto& _i : _items) {
         auto& _item = _i->box;
-        // Set usedSize in main axis to target size, in recurse, this
-        // usedSize will be used for available space
-        _item.usedSize[_main] = _item.targetSize[_main];
-        _item.format(*_i, true); 
         // After format recurse, the item has chosen a usedSize, set that as
         // hypothetical cross size, as we'll adjust that if align-self: stretch
         _item.hypoSize[_cross] = _item.usedSize[_cross];
@@ -483,7 +667,7 @@ void Box::format(Object& self, bool sizing) {
     }
 
     // Check container for definite cross-size
-    auto _crossSize = size.get(_cross).decode(*this, _parentSize[_cross]);
+    auto _crossSize = style(Field::Width, _cross).decode(*this, _parentSize[_cross]);
     CalcValue _innerCrossSize = _crossSize;
     if (_crossSize.definite()) {
         // Remove padding from the definite crossSize of the container
@@ -513,14 +697,14 @@ void Box::format(Object& self, bool sizing) {
 
     // If only 1 line, clamp it to the min/max
     if (_flexLines.size() == 1) { 
-        auto _min = min.get(_cross).decode(*this, _parentSize[_cross]);
-        auto _max = max.get(_cross).decode(*this, _parentSize[_cross]);
+        auto _min = style(Field::MinWidth, _cross).decode(*this, _parentSize[_cross]);
+        auto _max = style(Field::MaxWidth, _cross).decode(*this, _parentSize[_cross]);
         if (_min.definite()) _flexLines[0].crossSize = std::max(_flexLines[0].crossSize, _min.value);
         if (_max.definite()) _flexLines[0].crossSize = std::min(_flexLines[0].crossSize, _max.value);
     }
 
     // Handle align-content: stretch, divide leftover space to lines equaly
-    if (align.content == Align::Stretch && _innerCrossSize.definite()) {
+    if (style(Field::AlignContent) == Align::Stretch && _innerCrossSize.definite()) {
         float _sumCrossSize = 0; // Find sum of cross sizes
         for (auto& _line : _flexLines) _sumCrossSize += _line.crossSize;
         if (_sumCrossSize < _innerCrossSize) { // If space leftover, add equal portion to all lines
@@ -531,51 +715,95 @@ void Box::format(Object& self, bool sizing) {
 
     // Find the used-cross-size of all the items
     float _usedCrossSpace = 0; // While keeping track of it
+    std::vector<Object*> _stretched; // Formatted together when parallel
     for (auto& _line : _flexLines) {
         _usedCrossSpace += _line.crossSize;
         for (auto& _i : _line.items) {
             auto& _item = _i->box;
-            Value _selfAlign = _item.align.self; // Find self align
-            if (_item.align.self.is(Value::Auto)) // if auto, use container's item align
-                _selfAlign = align.items;
+            CalcValue _selfAlign = _item.style(Field::AlignSelf); // Find self align
+            if (_selfAlign.is(Value::Type::Auto)) // if auto, use container's item align
+                _selfAlign = style(Field::AlignItems);
             if (!_selfAlign.definite()) _selfAlign = Align::Stretch; // fallback
             // If stretch, set used-cross-size to line's cross-size minus margin
             if (_selfAlign == Align::Stretch && 
-                _item.size.get(_cross).is(Value::Auto)) {
+                _item.style(Field::Width, _cross).is(Value::Type::Auto)) {
                 _item.usedSize[_cross] = _line.crossSize
-                    - _item.margin.get(_cross)
-                    - _item.margin.get(_cross + 2);
-                _item.format(*_i, true); // Format again with new size
+                    - _item.style(Field::MarginLeft, _cross)
+                    - _item.style(Field::MarginLeft, _cross + 2);
+                if (parallel) _stretched.push_back(&*_i);
+                else _item.format(*_i, true); // Format again with new size
             } else { // No stretch, just use hypothetical-cross-size
                 _item.usedSize[_cross] = _item.hypoSize[_cross];
             }
         }
     }
 
+    formatItems(_stretched, true);
+
     // Determine container's used cross size
-    auto _calcCrossSize = size.get(_cross).decode(*this, _parentSize[_cross]);
+    auto _calcCrossSize = style(Field::Width, _cross).decode(*this, _parentSize[_cross]);
     if (_calcCrossSize.definite()) usedSize[_cross] = _calcCrossSize;
     else if (!usedSize[_cross].definite()) usedSize[_cross] = _usedCrossSpace;
     // Clamp to min/max
     usedSize[_cross] = clamp(*this, _parentSize[_cross], 
-        usedSize[_cross], min.get(_cross), max.get(_cross));
+        usedSize[_cross], style(Field::MinWidth, _cross), style(Field::MaxWidth, _cross));
     
-    if (sizing) return;
+    return true; // Sizes are known, items can be placed
+}
 
+std::optional<Vec2<float>> Box::measure(Object& self, Vec2<CalcValue> available) {
+    constexpr float _infinite = std::numeric_limits<float>::infinity();
+    const Vec2<CalcValue> _parentSize = parent ? parent->innerAvailableSize : Vec2<CalcValue>{ Value::Type::Infinite, Value::Type::Infinite };
+
+    // Space for the content is inside the padding
+    Vec2<float> _space{};
+    for (std::size_t _dim = 0; _dim < 2; ++_dim) {
+        const CalcValue _inner = subPadding(available[_dim], _dim, _parentSize[_dim]).decode(*this, _parentSize[_dim]);
+        _space[_dim] = _inner.definite() ? std::max(_inner.value, 0.f) : _infinite;
+    }
+
+    auto _measured = std::find_if(measured.begin(), measured.end(), 
+        [&](const Measured& m) { return m.valid && m.space == _space; });
+    if (_measured == measured.end()) {
+        _measured = measured.begin() + measuredNext;
+        measuredNext = (measuredNext + 1) % measured.size();
+        *_measured = { true, _space };
+        if (auto _size = self.measure(_space)) _measured->size = Vec2<float>{ _size->width(), _size->height() };
+        ++statistics.measures;
+    }
+
+    if (!_measured->size) return {};
+    Vec2<float> _size = *_measured->size;
+    for (std::size_t _dim = 0; _dim < 2; ++_dim)
+        _size[_dim] = addPadding(_size[_dim], _dim, _parentSize[_dim]).value;
+    return _size;
+}
+
+void Box::place(Object& self) {
     // ===================================================
     // Step 6: Axis-Alignment
     // ===================================================
 
+    // Same as during sizing, nothing they depend on has changed since
+    std::size_t _main = flowDirection();
+    std::size_t _cross = _main == 1 ? 0 : 1;
+    auto _parentSize = parent ? parent->innerAvailableSize : Vec2<CalcValue>{ windowSize[0], windowSize[1] };
+    auto _availableSize = innerAvailableSize[_main].definite() 
+        ? innerAvailableSize[_main].value : std::numeric_limits<float>::infinity();
+    auto& _flexLines = lines;
+    float _usedCrossSpace = 0;
+    for (auto& _line : _flexLines) _usedCrossSpace += _line.crossSize;
+
     // Determine if we have free space in the cross dimension
     float _freeCrossSpace = usedSize[_cross] - _usedCrossSpace;
     if (_freeCrossSpace < 0) _freeCrossSpace = 0;
 
     // Determine content box using padding and usedSize/position
     Vec4<float> _padding{
-        padding.get(0).decode(*this, _parentSize[0]),
-        padding.get(1).decode(*this, _parentSize[1]),
-        padding.get(2).decode(*this, _parentSize[0]),
-        padding.get(3).decode(*this, _parentSize[1]),
+        style(Field::PaddingLeft, 0).decode(*this, _parentSize[0]),
+        style(Field::PaddingLeft, 1).decode(*this, _parentSize[1]),
+        style(Field::PaddingLeft, 2).decode(*this, _parentSize[0]),
+        style(Field::PaddingLeft, 3).decode(*this, _parentSize[1]),
     };
     
     // Determine the content box, so we know where to position items
@@ -589,13 +817,13 @@ void Box::format(Object& self, bool sizing) {
 
     // Determine the flex-direction
     Direction _direction = Direction::Row;
-    if (flex.direction.is(Value::Enum))
-        _direction = flex.direction.as<Direction>();
+    if (style(Field::FlexDirection).is(Value::Type::Enum))
+        _direction = style(Field::FlexDirection).as<Direction>();
 
     // handle align-content
     Align _content = Align::Start;
-    if (align.content.is(Value::Enum))
-        _content = align.content.as<Align>();
+    if (style(Field::AlignContent).is(Value::Type::Enum))
+        _content = style(Field::AlignContent).as<Align>();
     float _crossStart = _innerContentBox[_cross], _crossDistance = 0.f, _crossDir = 1.f;
     switch (_content) {
     case Align::Start:
@@ -628,6 +856,9 @@ void Box::format(Object& self, bool sizing) {
         _crossDir *= -1, _crossStart = _innerContentBox.center()[_cross]
             + (_innerContentBox.center()[_cross] - _crossStart);
 
+    // Large subtrees are placed in parallel once all items have been sized
+    std::vector<Deferred> _deferred;
+
     self.scrollbar[_main].range = { _innerContentBox[_main], 0}; // reset scroll size
     self.scrollbar[_cross].range = { _innerContentBox[_cross], 0 }; // reset scroll size
     for (auto& _line : _flexLines) {
@@ -644,8 +875,8 @@ void Box::format(Object& self, bool sizing) {
 
         // handle justify-content
         Justify _justify = Justify::Start;
-        if (justify.is(Value::Enum))
-            _justify = justify.as<Justify>();
+        if (style(Field::Justify).is(Value::Type::Enum))
+            _justify = style(Field::Justify).as<Justify>();
         float _mainStart = 0, _mainDistance = 0, _mainDir = 1;
         switch (_justify) {
         case Justify::Start: 
@@ -681,18 +912,18 @@ void Box::format(Object& self, bool sizing) {
             auto& _item = _i->box;
             // Calculate the margin
             Vec4<float> _margin{
-                _item.margin.get(0).decode(_item, innerAvailableSize[0]),
-                _item.margin.get(1).decode(_item, innerAvailableSize[1]),
-                _item.margin.get(2).decode(_item, innerAvailableSize[0]),
-                _item.margin.get(3).decode(_item, innerAvailableSize[1]),
+                _item.style(Field::MarginLeft, 0).decode(_item, innerAvailableSize[0]),
+                _item.style(Field::MarginLeft, 1).decode(_item, innerAvailableSize[1]),
+                _item.style(Field::MarginLeft, 2).decode(_item, innerAvailableSize[0]),
+                _item.style(Field::MarginLeft, 3).decode(_item, innerAvailableSize[1]),
             };
 
             // Handle align-self, or align-items if align-self: auto
             Align _selfAlign = Align::Stretch;
-            if (_item.align.self.is(Value::Enum))
-                _selfAlign = _item.align.self.as<Align>(); // Find self align
-            else if (_item.align.self.is(Value::Auto)) // if auto, use container's item align
-                _selfAlign = align.items.as<Align>();
+            if (_item.style(Field::AlignSelf).is(Value::Type::Enum))
+                _selfAlign = _item.style(Field::AlignSelf).as<Align>(); // Find self align
+            else if (_item.style(Field::AlignSelf).is(Value::Type::Auto)) // if auto, use container's item align
+                _selfAlign = style(Field::AlignItems).as<Align>();
             float _crossOffset = 0;
             switch (_selfAlign) {
             case Align::End:
@@ -709,18 +940,25 @@ void Box::format(Object& self, bool sizing) {
             const float _crossPos = _crossStart + _margin[_cross] + _crossOffset;
             const float _mainPos = _mainStart + _margin[_main];
 
-            (*_i)[_cross] = _crossPos - self.scrollbar[_cross].scrolled;
-            (*_i)[_main] = _mainPos - self.scrollbar[_main].scrolled;
+            // Not scrolled, drawing and hit testing take care of that
+            (*_i)[_cross] = _crossPos;
+            (*_i)[_main] = _mainPos;
+
+            _item.format(*_i, false, parallel ? &_deferred : nullptr);
 
-            _item.format(*_i);
+            const float _crossSize = _item.usedSize[_cross];
+            const float _mainSize = _item.usedSize[_main];
 
-            (*_i)[_cross + 2] = _item.usedSize[_cross];
-            (*_i)[_main + 2] = _item.usedSize[_main];
+            // Placing a deferred item still sees its old size, like it does here
+            if (_deferred.empty() || _deferred.back().object != &*_i) {
+                (*_i)[_cross + 2] = _crossSize;
+                (*_i)[_main + 2] = _mainSize;
+            }
 
-            if (_mainPos + (*_i)[_main + 2] + _margin[_main + 2] > self.scrollbar[_main].range[1])
-                self.scrollbar[_main].range[1] = _mainPos + (*_i)[_main + 2] + _margin[_main + 2];
-            if (_crossPos + (*_i)[_cross + 2] + _margin[_cross + 2] > self.scrollbar[_cross].range[1])
-                self.scrollbar[_cross].range[1] = _crossPos + (*_i)[_cross + 2] + _margin[_cross + 2];
+            if (_mainPos + _mainSize + _margin[_main + 2] > self.scrollbar[_main].range[1])
+                self.scrollbar[_main].range[1] = _mainPos + _mainSize + _margin[_main + 2];
+            if (_crossPos + _crossSize + _margin[_cross + 2] > self.scrollbar[_cross].range[1])
+                self.scrollbar[_cross].range[1] = _crossPos + _crossSize + _margin[_cross + 2];
             if (_mainPos - _margin[_main] < self.scrollbar[_main].range[0])
                 self.scrollbar[_main].range[0] = _mainPos - _margin[_main];
             if (_crossPos - _margin[_cross] < self.scrollbar[_cross].range[0])
@@ -740,6 +978,17 @@ void Box::format(Object& self, bool sizing) {
         _crossStart += _crossDir * _crossDistance;
     }
 
+    pool().run(_deferred.size(), [&](std::size_t i) {
+        auto& [_object, _input, _animating] = _deferred[i];
+        _object->box.place(*_object);
+        _object->box.finish(*_object, _input, _animating);
+    });
+
+    for (auto& _item : _deferred) {
+        (*_item.object)[_cross + 2] = _item.object->box.usedSize[_cross];
+        (*_item.object)[_main + 2] = _item.object->box.usedSize[_main];
+    }
+
     // Calculate actual scroll size
     self.scrollbar[0].range[0] = std::min(self.scrollbar[0].range[0] - _innerContentBox[0], 0.f);
     self.scrollbar[1].range[0] = std::min(self.scrollbar[1].range[0] - _innerContentBox[1], 0.f);
@@ -748,13 +997,182 @@ void Box::format(Object& self, bool sizing) {
     
     self.scrollbar.x->visible = (self.scrollbar.x->range[0] != 0
         || self.scrollbar.x->range[1] != 0
-        || overflow.x == Flex::Overflow::Scroll)
-        && overflow.x != Flex::Overflow::Hidden;
+        || style(Field::OverflowX) == Flex::Overflow::Scroll)
+        && style(Field::OverflowX) != Flex::Overflow::Hidden;
     self.scrollbar.x->dimensions(self.dimensions());
 
     self.scrollbar.y->visible = (self.scrollbar.y->range[0] != 0
         || self.scrollbar.y->range[1] != 0
-        || overflow.y == Flex::Overflow::Scroll)
-        && overflow.y != Flex::Overflow::Hidden;
+        || style(Field::OverflowY) == Flex::Overflow::Scroll)
+        && style(Field::OverflowY) != Flex::Overflow::Hidden;
     self.scrollbar.y->dimensions(self.dimensions());
+    self.placed();
 }
+
+void Box::resolveFlexibleLengths(Line& line, std::size_t _main, float _availableSize) {
+    // Unfrozen items are sized base + x * scaled, where x is the free space
+    // per scaled flex factor. Most lines settle in a few iterations, those
+    // only go over the items that aren't frozen yet. When a line keeps going
+    // the items are sorted by the x below which they violate their min, and
+    // the x above which they violate their max. The violating items are then
+    // a prefix of the sorted order, which is frozen as a batch, and the
+    // total violation of the prefixes is summed in logarithmic time.
+    using enum Flexing;
+    const Flexing _type = line.usedSpace > _availableSize ? Shrink : Grow;
+    const Field _flexFactor = _type == Shrink ? Field::FlexShrink : Field::FlexGrow;
+    constexpr float _infinite = std::numeric_limits<float>::infinity();
+    constexpr std::size_t _scans = 8; // Iterations before sorting
+
+    Resolution& _r = resolution;
+    auto& _items = _r.items;
+    auto& _active = _r.active;
+    _items.clear();
+    _active.clear();
+
+    double _used = 0;    // Outer target size of frozen, outer flex-base-size of unfrozen items
+    double _factors = 0; // Flex factors of unfrozen items
+    double _scaled = 0;  // Scaled flex factors of unfrozen items
+    std::size_t _unfrozen = 0;
+
+    for (auto& _i : line.items) {
+        auto& _item = _i->box;
+        const CalcValue _min = _item.style(Field::MinWidth, _main).decode(_item, _availableSize);
+        const CalcValue _max = _item.style(Field::MaxWidth, _main).decode(_item, _availableSize);
+        const float _factor = _item.style(_flexFactor);
+        Flexible& _flexible = _items.emplace_back(Flexible{
+            .box = &_item,
+            .base = _item.flexBaseSize,
+            .outerBase = _item.outerFlexBaseSize,
+            .margin = _item.addMargin(0.f, _main, _availableSize),
+            .factor = _factor,
+            .scaled = _type == Shrink ? _factor * _item.flexBaseSize : _factor,
+            .min = _min.definite() ? _min.value : 0.f,
+            .max = _max.definite() ? _max.value : _infinite,
+        });
+        _flexible.min = std::min(_flexible.min, _flexible.max); // Max wins when they conflict
+
+        // Freeze items that don't flex, their space usage is the hypothetical size
+        const bool _sizing = _type == Shrink
+            ? _item.flexBaseSize < _item.hypoSize[_main]
+            : _item.flexBaseSize > _item.hypoSize[_main];
+        if (_flexible.factor == 0 || _sizing) {
+            _flexible.frozen = true;
+            _flexible.target = _item.hypoSize[_main];
+        } else {
+            _active.push_back(static_cast<std::uint32_t>(_items.size() - 1));
+            _factors += _flexible.factor;
+            _scaled += _flexible.scaled;
+            ++_unfrozen;
+        }
+        _used += _flexible.frozen ? _flexible.target + _flexible.margin : _flexible.outerBase;
+    }
+    const double _initialFreeSpace = _availableSize - _used;
+
+    bool _sorted = false;
+    std::size_t _minNext = 0; // Items before these in byMin/byMax are all frozen
+    std::size_t _maxNext = 0;
+
+    // Sort the unfrozen items by their thresholds
+    const auto _sort = [&] {
+        std::erase_if(_active, [&](std::uint32_t i) { return _items[i].frozen; });
+        for (auto _i : _active) {
+            auto& _item = _items[_i];
+            if (_item.scaled > 0) {
+                _item.minAt = (static_cast<double>(_item.min) - _item.base) / _item.scaled;
+                _item.maxAt = (static_cast<double>(_item.max) - _item.base) / _item.scaled;
+            } else { // Size doesn't change, violates for any x or none
+                _item.minAt = _item.base < _item.min ? _infinite : -_infinite;
+                _item.maxAt = _item.base > _item.max ? -_infinite : _infinite;
+            }
+        }
+
+        _r.byMin = _active, _r.byMax = _active;
+        std::ranges::sort(_r.byMin, std::greater{}, [&](std::uint32_t i) { return _items[i].minAt; });
+        std::ranges::sort(_r.byMax, std::less{}, [&](std::uint32_t i) { return _items[i].maxAt; });
+
+        const std::size_t _size = _active.size();
+        _r.minSpace.assign(_size, 0), _r.minScaled.assign(_size, 0);
+        _r.maxSpace.assign(_size, 0), _r.maxScaled.assign(_size, 0);
+        for (std::uint32_t _k = 0; _k < _size; ++_k) {
+            auto& _byMin = _items[_r.byMin[_k]];
+            _byMin.minRank = _k;
+            _r.minSpace.set(_k, static_cast<double>(_byMin.min) - _byMin.base);
+            _r.minScaled.set(_k, _byMin.scaled);
+            auto& _byMax = _items[_r.byMax[_k]];
+            _byMax.maxRank = _k;
+            if (_byMax.max != _infinite) _r.maxSpace.set(_k, static_cast<double>(_byMax.max) - _byMax.base);
+            _r.maxScaled.set(_k, _byMax.scaled);
+        }
+        _sorted = true;
+    };
+
+    const auto _freeze = [&](std::uint32_t i, float target) {
+        auto& _item = _items[i];
+        if (_item.frozen) return;
+        _item.frozen = true;
+        _item.target = target;
+        _used += _item.target + _item.margin - _item.outerBase;
+        _factors -= _item.factor;
+        _scaled -= _item.scaled;
+        --_unfrozen;
+        if (_sorted) { // Remove from the sums
+            _r.minSpace.set(_item.minRank, 0), _r.minScaled.set(_item.minRank, 0);
+            _r.maxSpace.set(_item.maxRank, 0), _r.maxScaled.set(_item.maxRank, 0);
+        }
+    };
+
+    for (std::size_t _iteration = 1; _unfrozen != 0; ++_iteration) {
+        // Calculate the remaining free space, and distribute it per flex factor
+        double _freeSpace = _availableSize - _used;
+        if (_factors < 1 && _initialFreeSpace * _factors < _freeSpace)
+            _freeSpace = _initialFreeSpace * _factors;
+        const double _x = _freeSpace == 0 || _scaled <= 0 ? 0
+            : (_type == Shrink ? -std::abs(_freeSpace) : _freeSpace) / _scaled;
+        const auto _target = [&](const Flexible& item) {
+            return item.scaled == 0 ? item.base : item.base + _x * item.scaled;
+        };
+
+        // Total violation, positive when clamping to min grows items more
+        // than clamping to max shrinks them. Freeze the min violations when
+        // positive, the max violations when negative.
+        const std::size_t _before = _unfrozen;
+        if (!_sorted) {
+            double _violation = 0;
+            for (auto _i : _active) {
+                auto& _item = _items[_i];
+                const double _size = _target(_item);
+                if (_size < _item.min) _violation += _item.min - _size;
+                else if (_size > _item.max) _violation += _item.max - _size;
+            }
+            for (auto _i : _active) {
+                auto& _item = _items[_i];
+                const double _size = _target(_item);
+                if (_violation > 0 && _size < _item.min) _freeze(_i, _item.min);
+                else if (_violation < 0 && _size > _item.max) _freeze(_i, _item.max);
+            }
+            std::erase_if(_active, [&](std::uint32_t i) { return _items[i].frozen; });
+        } else {
+            const auto _minEnd = static_cast<std::size_t>(std::ranges::partition_point(_r.byMin, [&](std::uint32_t i) { return _items[i].minAt > _x; }) - _r.byMin.begin());
+            const auto _maxEnd = static_cast<std::size_t>(std::ranges::partition_point(_r.byMax, [&](std::uint32_t i) { return _items[i].maxAt < _x; }) - _r.byMax.begin());
+            const auto _over = [&](double space, double scaled) { return scaled == 0 ? space : space - _x * scaled; };
+            const double _violation = _over(_r.minSpace.sum(_minEnd), _r.minScaled.sum(_minEnd))
+                                    + _over(_r.maxSpace.sum(_maxEnd), _r.maxScaled.sum(_maxEnd));
+            if (_violation > 0) for (; _minNext < _minEnd; ++_minNext) _freeze(_r.byMin[_minNext], _items[_r.byMin[_minNext]].min);
+            else if (_violation < 0) for (; _maxNext < _maxEnd; ++_maxNext) _freeze(_r.byMax[_maxNext], _items[_r.byMax[_maxNext]].max);
+        }
+
+        if (_unfrozen == _before) { // No violations (or only rounding errors), freeze the rest
+            for (auto _i : _active) {
+                auto& _item = _items[_i];
+                if (_item.frozen) continue;
+                _item.frozen = true;
+                _item.target = std::min(std::max(static_cast<float>(_target(_item)), _item.min), _item.max);
+            }
+            break;
+        }
+
+        if (_iteration == _scans && _unfrozen != 0) _sort();
+    }
+
+    for (auto& _item : _items) _item.box->targetSize[_main] = _item.target;
+}
\ No newline at end of file
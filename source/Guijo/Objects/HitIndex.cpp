@@ -0,0 +1,136 @@
+#include "Guijo/Objects/HitIndex.hpp"
+#include "Guijo/Objects/Object.hpp"
+
+using namespace Guijo;
+
+void HitIndex::update() {
+    if (!m_Dirty || !m_Root) return;
+    m_Dirty = false;
+
+    constexpr float _inf = std::numeric_limits<float>::infinity();
+    m_Entries.clear();
+    for (auto& _c : m_Root->laid())
+        if (_c->get(Visible)) add(*_c, { 0, 0 }, { -_inf, -_inf, _inf, _inf }, NoParent);
+
+    // Entries clipped away entirely keep their number, but can't be hit
+    m_Order.clear();
+    for (std::uint32_t _i = 0; _i < m_Entries.size(); ++_i)
+        if (!m_Entries[_i].bounds.empty()) m_Order.push_back(_i);
+    m_Nodes.assign(1, {});
+    build(0, 0, static_cast<std::uint32_t>(m_Order.size()));
+    m_Tested.assign(m_Entries.size(), 0);
+    m_Hitbox.assign(m_Entries.size(), false);
+    m_Query = 0;
+}
+
+void HitIndex::add(Object& object, Point<float> offset, Bounds clip, std::uint32_t parent) {
+    const auto _order = static_cast<std::uint32_t>(m_Entries.size());
+    const auto _dims = object.dimensions().translate(offset);
+    const Bounds _bounds{
+        std::max(_dims.left(), clip.x1), std::max(_dims.top(), clip.y1),
+        std::min(_dims.right(), clip.x2), std::min(_dims.bottom(), clip.y2) };
+    m_Entries.push_back({ _bounds, offset, &object, parent, _order + 1 });
+
+    auto& _hit = object.m_Hit;
+    if (_hit.scope.get() != this) remember(), _hit.scope = this;
+    _hit.order = _order;
+    _hit.offset = offset;
+    _hit.root = object.scrolling();
+
+    if (!_hit.root) { // Otherwise its children are in its own index
+        object.m_Hits = nullptr; // Not a scope (anymore), we index its children
+        if (object.clipping()) clip = _bounds; // Hitbox is its own dimensions
+        for (auto& _c : object.laid())
+            if (_c->get(Visible)) add(*_c, offset + object.scrolled(), clip, _order);
+        m_Entries[_order].last = static_cast<std::uint32_t>(m_Entries.size());
+    }
+}
+
+void HitIndex::build(std::uint32_t node, std::uint32_t first, std::uint32_t count) {
+    constexpr float _inf = std::numeric_limits<float>::infinity();
+    Node _node{ { _inf, _inf, -_inf, -_inf } };
+    for (std::uint32_t _i = first; _i < first + count; ++_i) {
+        auto& _bounds = m_Entries[m_Order[_i]].bounds;
+        _node.bounds.x1 = std::min(_node.bounds.x1, _bounds.x1);
+        _node.bounds.y1 = std::min(_node.bounds.y1, _bounds.y1);
+        _node.bounds.x2 = std::max(_node.bounds.x2, _bounds.x2);
+        _node.bounds.y2 = std::max(_node.bounds.y2, _bounds.y2);
+    }
+
+    if (count <= LeafSize) {
+        _node.first = first, _node.count = count;
+        m_Nodes[node] = _node;
+        return;
+    }
+
+    // Split at the median center along the widest side
+    auto& _b = _node.bounds;
+    const bool _vertical = _b.y2 - _b.y1 > _b.x2 - _b.x1;
+    const std::uint32_t _middle = first + count / 2;
+    std::nth_element(m_Order.begin() + first, m_Order.begin() + _middle, m_Order.begin() + first + count,
+        [&](std::uint32_t a, std::uint32_t b) {
+            auto& _a = m_Entries[a].bounds;
+            auto& _b = m_Entries[b].bounds;
+            return _vertical ? _a.y1 + _a.y2 < _b.y1 + _b.y2 : _a.x1 + _a.x2 < _b.x1 + _b.x2;
+        });
+
+    _node.first = static_cast<std::uint32_t>(m_Nodes.size());
+    m_Nodes[node] = _node;
+    m_Nodes.resize(m_Nodes.size() + 2);
+    build(_node.first, first, _middle - first);
+    build(_node.first + 1, _middle, first + count - _middle);
+}
+
+bool HitIndex::ready(const Object& object, std::uint32_t order) const {
+    return m_Root && !m_Dirty && order < m_Entries.size() && m_Entries[order].object == &object;
+}
+
+bool HitIndex::hit(Point<float> pos, std::uint32_t order) const {
+    query(pos);
+    const std::uint32_t _last = m_Entries[order].last;
+    auto _it = std::upper_bound(m_Under.begin(), m_Under.end(), order);
+    for (auto _i = static_cast<std::size_t>(_it - m_Under.begin()); _i < m_Under.size(); ++_i) {
+        const std::uint32_t _entry = m_Under[_i];
+        if (_entry >= _last) return false;
+
+        // Overridden hitboxes of the ancestors in between may refuse it
+        bool _hit = true;
+        for (auto _e = _entry; _hit && _e != order; _e = m_Entries[_e].parent)
+            _hit = hitbox(_e, pos);
+        if (_hit) return true;
+        query(pos); // Hitboxes may have queried elsewhere
+    }
+    return false;
+}
+
+bool HitIndex::hitbox(std::uint32_t entry, Point<float> pos) const {
+    if (m_Tested[entry] == m_Query) return m_Hitbox[entry];
+    const std::uint32_t _query = m_Query;
+    auto& _entry = m_Entries[entry];
+    const bool _hit = _entry.object->hitbox(pos + _entry.offset);
+    if (_query == m_Query) m_Tested[entry] = m_Query, m_Hitbox[entry] = _hit;
+    return _hit;
+}
+
+void HitIndex::query(Point<float> pos) const {
+    if (m_Query != 0 && m_Position == pos) return;
+
+    m_Under.clear();
+    std::uint32_t _stack[64]; // Twice the depth of a tree of 4 billion objects
+    std::size_t _size = 0;
+    if (!m_Order.empty()) _stack[_size++] = 0;
+    while (_size) {
+        auto& _node = m_Nodes[_stack[--_size]];
+        if (!_node.bounds.contains(pos)) continue;
+        if (_node.count == 0) {
+            _stack[_size++] = _node.first;
+            _stack[_size++] = _node.first + 1;
+        } else {
+            for (std::uint32_t _i = _node.first; _i < _node.first + _node.count; ++_i)
+                if (m_Entries[m_Order[_i]].bounds.contains(pos)) m_Under.push_back(m_Order[_i]);
+        }
+    }
+    std::sort(m_Under.begin(), m_Under.end());
+    if (++m_Query == 0) std::ranges::fill(m_Tested, 0), m_Query = 1;
+    m_Position = pos;
+}
\ No newline at end of file
@@ -28,36 +28,48 @@ Object::Object() {
     state<[](const MousePress&, EventReceiver& c) { return c.get(Hovering); }>(Pressed);
     state<[](const MouseRelease&, EventReceiver&) { return false; }>(Pressed);
     state<[](const MouseExit&, EventReceiver&) { return false; }>(Hovering);
-    // Link all FlexBox attributes as state listeners
-    link(box.size.width);
-    link(box.size.height);
-    link(box.min.width);
-    link(box.max.height);
-    link(box.margin.left);
-    link(box.margin.top);
-    link(box.margin.right);
-    link(box.margin.bottom);
-    link(box.padding.left);
-    link(box.padding.top);
-    link(box.padding.right);
-    link(box.padding.bottom);
-    link(box.flex.basis);
-    link(box.flex.grow);
-    link(box.flex.shrink);
+    // Box values linked to states follow ours, and so do those of its class
+    box.receiver = this;
+    link(box);
+}
+
+Object::~Object() {
+    // Children may outlive us, don't let them invalidate a deleted box
+    for (auto& _c : objects()) _c->box.parent = nullptr;
+    if (m_Hits) m_Hits->detach(); // Descendants may still refer to our index
+    if (m_Hit.scope) m_Hit.scope->invalidate(); // Don't test us until rebuilt
 }
 
 bool Object::hitbox(Point<float> pos) const {
-    if (box.overflow.x != Flex::Overflow::Visible
-     || box.overflow.y != Flex::Overflow::Visible) {
+    if (clipping()) {
         return contains(pos);
     } else {
         if (contains(pos)) return true;
+        // Descendants are hit tested in the index of our scope
+        if (m_Hit.scope && m_Hit.scope->ready(*this, m_Hit.order))
+            return m_Hit.scope->hit(pos - m_Hit.offset, m_Hit.order);
         for (auto& _c : objects())
-            if (_c->hitbox(pos)) return true;
+            if (_c->get(Visible) && _c->hitbox(pos + scrolled())) return true;
         return false;
     }
 }
 
+bool Object::clipping() const {
+    return box.overflow.x != Flex::Overflow::Visible
+        || box.overflow.y != Flex::Overflow::Visible;
+}
+
+bool Object::scrolling() const {
+    return clipping() && (scrollbar.x->visible || scrollbar.y->visible);
+}
+
+void Object::placed() {
+    // The index our children are in has to be rebuilt, that of our scope
+    // too when they're in it, or were in it before we started scrolling.
+    if (m_Hits) m_Hits->invalidate();
+    if (m_Hit.scope && (!m_Hit.root || !scrolling())) m_Hit.scope->invalidate();
+}
+
 void Object::pre(DrawContext& context) const {
     context.pushClip();
     if (box.overflow.x != Flex::Overflow::Visible
@@ -68,11 +80,21 @@ void Object::pre(DrawContext& context) const {
 }
 
 void Object::draw(DrawContext& context) const {
-    for (auto& _c : objects()) if (_c->get(Visible)) {
+    const Point<float> _scrolled = scrolled();
+    // Scroll containers draw their children in a layer, scrolling then
+    // moves the pixels that were kept instead of drawing everything again.
+    // Overflow is Auto by default, so only those that can scroll get one.
+    const bool _layer = scrolling();
+    const bool _translate = !_layer && (_scrolled.x() != 0 || _scrolled.y() != 0);
+    if (_layer) context.pushLayer({ reinterpret_cast<std::size_t>(this), dimensions().inset(box.padding), _scrolled });
+    else if (_translate) context.pushMatrix(), context.translate(_scrolled * -1);
+    for (auto& _c : laid()) if (_c->get(Visible)) {
         _c->pre(context);
         _c->draw(context);
         _c->post(context);
     }
+    if (_layer) context.popLayer();
+    else if (_translate) context.popMatrix();
 }
 
 void Object::post(DrawContext& context) const {
@@ -85,27 +107,56 @@ void Object::post(DrawContext& context) const {
 void Object::update() {
     auto _it = objects().begin();
     while (_it != objects().end()) {
-        if ((*_it)->get(Delete)) _it = objects().erase(_it);
-        else ++_it;
+        if ((*_it)->get(Delete)) {
+            (*_it)->box.parent = nullptr;
+            _it = objects().erase(_it);
+            box.invalidate();
+        } else ++_it;
     }
     for (auto& _c : objects()) if (_c->get(Visible)) _c->update();
 }
 
+Point<float> Object::scrolled() const {
+    return { scrollbar.x->scrolled.get(), scrollbar.y->scrolled.get() };
+}
+
 void Object::handle(const Event& e) {
+    // Bring the index our children are hit tested with up to date,
+    // scopes further down do the same once the event gets there.
+    if (scrolling() || box.parent == nullptr) {
+        if (!m_Hits) m_Hits = new HitIndex{ *this };
+        m_Hits->update();
+    }
+
     if (scrollbar.x && scrollbar.x->visible) 
         if (e.forward(*scrollbar.x)) scrollbar.x->handle(e);
     if (scrollbar.y && scrollbar.y->visible)
         if (e.forward(*scrollbar.y)) scrollbar.y->handle(e);
-    for (auto& _c : objects()) // Forward event to sub-objects
+
+    // Children get positions in their own coordinates. The window owns
+    // the event, it's only const to handlers.
+    const Point<float> _scrolled = scrolled();
+    const bool _translate = _scrolled.x() != 0 || _scrolled.y() != 0;
+    auto& _event = const_cast<Event&>(e);
+    const auto _toChildren = [&] { if (_translate) _event.translate(_scrolled); };
+    const auto _toSelf = [&] { if (_translate) _event.translate(_scrolled * -1); };
+
+    _toChildren();
+    for (auto& _c : laid()) // Forward event to sub-objects
         if (_c->get(Visible)) if (e.forward(*_c)) _c->handle(e);
-    for (auto& _h : m_StateHandlers) { // Handle state
-        State _matches = 0;
-        if (scrollbar.x && scrollbar.x->visible)
-            _matches += _h->handle(*this, e, *scrollbar.x, _matches);
-        if (scrollbar.y && scrollbar.y->visible)
-            _matches += _h->handle(*this, e, *scrollbar.y, _matches);
-        for (auto & _c : std::views::reverse(objects()))
-            if (_c->get(Visible)) _matches += _h->handle(*this, e, *_c, _matches);
+    _toSelf();
+    if (e.type() < m_StateHandlers.size()) {
+        for (auto& _h : m_StateHandlers[e.type()]) { // Handle state
+            State _matches = 0;
+            if (scrollbar.x && scrollbar.x->visible)
+                _matches += _h->handle(e, *scrollbar.x, _matches);
+            if (scrollbar.y && scrollbar.y->visible)
+                _matches += _h->handle(e, *scrollbar.y, _matches);
+            _toChildren();
+            for (auto & _c : std::views::reverse(laid()))
+                if (_c->get(Visible)) _matches += _h->handle(e, *_c, _matches);
+            _toSelf();
+        }
     }
     EventReceiver::handle(e);
 }
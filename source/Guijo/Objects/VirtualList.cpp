@@ -0,0 +1,89 @@
+#include "Guijo/Objects/VirtualList.hpp"
+
+using namespace Guijo;
+
+VirtualList::VirtualList(std::size_t count, Factory create, float estimate)
+    : estimate(estimate), m_Create(std::move(create)), m_Heights(count, estimate) {
+    box.flex.direction = Flex::Column;
+    m_Before->box.flex.shrink = 0;
+    m_After->box.flex.shrink = 0;
+    m_Objects = { m_Before, m_After };
+}
+
+VirtualList::~VirtualList() {
+    // Object's destructor only sees its own children
+    for (auto& _c : m_Objects) _c->box.parent = nullptr;
+}
+
+void VirtualList::count(std::size_t count) {
+    release(m_First, m_Last);
+    m_Heights.assign(count, estimate);
+    m_First = m_Last = 0;
+    m_Objects = { m_Before, m_After };
+    box.invalidate();
+}
+
+void VirtualList::refresh() {
+    release(m_First, m_Last);
+    m_Last = m_First;
+    m_Objects = { m_Before, m_After };
+    box.invalidate();
+}
+
+void VirtualList::release(std::size_t first, std::size_t last) {
+    for (std::size_t _i = first; _i < last; ++_i) row(_i).box.parent = nullptr;
+}
+
+std::pair<std::size_t, std::size_t> VirtualList::visible() const {
+    // Rows overlapping the view and overscan, in content coordinates
+    const float _top = scrollbar.y->scrolled;
+    const std::size_t _first = std::min(m_Heights.find(_top - overscan), count());
+    const std::size_t _last = std::min(m_Heights.find(_top + m_View + overscan) + 1, count());
+    return { _first, _last };
+}
+
+bool VirtualList::materialize() {
+    const auto [_first, _last] = visible();
+    if (_first == m_First && _last == m_Last) return false;
+
+    std::vector<Pointer<Object>> _objects;
+    _objects.reserve(_last - _first + 2);
+    _objects.push_back(m_Before);
+    for (std::size_t _i = _first; _i < _last; ++_i) {
+        if (_i >= m_First && _i < m_Last) _objects.push_back(m_Objects[_i - m_First + 1]); // Still in view
+        else {
+            _objects.push_back(m_Create(_i));
+            _objects.back()->box.flex.shrink = 0; // Rows keep their height, the list scrolls
+        }
+    }
+    _objects.push_back(m_After);
+
+    release(m_First, std::min(_first, m_Last));
+    release(std::max(_last, m_First), m_Last);
+    m_Objects = std::move(_objects);
+    m_First = _first, m_Last = _last;
+
+    m_Before->box.size.height = static_cast<float>(m_Heights.sum(_first));
+    m_After->box.size.height = static_cast<float>(m_Heights.total() - m_Heights.sum(_last));
+    return true;
+}
+
+void VirtualList::update() {
+    // Every row was laid out since the last update, rows picked in
+    // there were invalidated, so they're drawn from now on.
+    m_Laid = m_Objects;
+
+    // Distance to the next object is the row's height including margins,
+    // layout again when it differs from the estimate or last measurement.
+    bool _changed = false;
+    for (std::size_t _i = m_First; _i < m_Last; ++_i) {
+        const float _height = m_Objects[_i - m_First + 2]->y() - row(_i).y();
+        if (_height != m_Heights[_i]) m_Heights.set(_i, _height), _changed = true;
+    }
+
+    // Scrolling doesn't lay out, only when other rows come into view
+    m_View = height();
+    if (materialize() || _changed) box.invalidate();
+
+    for (auto& _c : m_Objects) if (_c->get(Visible)) _c->update();
+}
\ No newline at end of file
@@ -1,6 +1,15 @@
 #include "Guijo/Window/Window.hpp"
+#include "Guijo/Utils/Worker.hpp"
 using namespace Guijo;
 
+static HANDLE wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr); // Signalled by wake()
+
+// Windows render one after the other, so they share the thread their layout runs on
+static Worker& layoutWorker() {
+    static Worker _worker;
+    return _worker;
+}
+
 Window::Window(const Construct& c) {
     createWindow(c);
 };
@@ -117,70 +126,105 @@ bool Window::loop() {
         }
         if (++_handled > 30) break;
     }
-    windowsLoop();
 
+    if (_handled != 0 || !m_EventQueue.empty()) redraw = true;
     while (!m_EventQueue.empty()) { // Event cycle
-        handle(*m_EventQueue.front());
+        handle(m_EventQueue.front());
         m_EventQueue.pop();
     }
 
     return !m_ShouldExit;
 }
 
-void Window::windowsLoop() {
+void Window::frame() {
+    redraw = false;
     box.size = size();
     box.windowSize = size();
-    box.format(*this);
+
+    if (pipelined) {
+        // Only the layout touches the objects until the commit point, the
+        // frame committed last time is rendered in the meantime.
+        layoutWorker().start([this] { box.format(*this); });
+        if (!m_Presented) present();
+        layoutWorker().wait(); // Commit point, geometry of this frame is final
+    } else box.format(*this);
 
     update(); // Update cycle
 
-    m_Graphics.prepare(); // Graphics cycle
-    pre(m_Graphics.context);
-    draw(m_Graphics.context);
-    post(m_Graphics.context);
+    pre(m_Graphics.context()); // Record this frame's commands
+    draw(m_Graphics.context());
+    post(m_Graphics.context());
+    m_Graphics.commit();
+    m_Presented = false;
+
+    // Without a next frame to overlap with, render this one right away
+    if (!pipelined || !(redraw || box.needsLayout() || animating())) present();
+}
+
+void Window::present() {
+    m_Graphics.prepare();
     m_Graphics.render();
     m_Graphics.swapBuffers();
+    m_Presented = true;
 }
 
 void Window::cursorEvent(float x, float y, KeyMod mod) {
     cursor.position = { x, y };
-    if (cursor.buttons == MouseButton::None) m_EventQueue.emplace(new MouseMove{ { x, y } });
-    else m_EventQueue.emplace(new MouseDrag{ cursor.pressed, { x, y }, cursor.buttons, mod });
+    m_EventQueue.history = pointerHistory;
+    if (cursor.buttons == MouseButton::None) queue(MouseMove{ { x, y } });
+    else queue(MouseDrag{ cursor.pressed, { x, y }, cursor.buttons, mod });
 }
 
 void Window::mouseButtonEvent(MouseButton button, bool press, KeyMod mod) {
     if (press) {
         cursor.buttons |= button; // Add button to pressed
         cursor.pressed = cursor.position; // Set press cursor position
-        m_EventQueue.emplace(new MousePress{ cursor.position, button, mod });
+        queue(MousePress{ cursor.position, button, mod });
     } else {
         cursor.buttons ^= button; // Remove button from pressed
         if (cursor.pressed == cursor.position) // If pos not changed, add click
-            m_EventQueue.emplace(new MouseClick{ cursor.position, button, mod });
+            queue(MouseClick{ cursor.position, button, mod });
 
-        m_EventQueue.emplace(new MouseRelease{ cursor.position, button, mod });
+        queue(MouseRelease{ cursor.position, button, mod });
     }
 }
 
 void Window::mouseWheelEvent(std::int16_t amount, KeyMod mod, float x, float y) {
-    m_EventQueue.emplace(new MouseWheel{ { x, y }, amount, mod });
+    queue(MouseWheel{ { x, y }, amount, mod });
 }
 
 void Window::keyEvent(KeyCode key, bool repeat, int action, KeyMod mod) {
     if (action == 0) // Release
-        m_EventQueue.emplace(new KeyRelease{ key, mod });
+        queue(KeyRelease{ key, mod });
     else if (action == 1) // Press
-        m_EventQueue.emplace(new KeyPress{ key, mod, repeat });
+        queue(KeyPress{ key, mod, repeat });
     else {
         std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> conversion;
-        m_EventQueue.emplace(new KeyType{ conversion.to_bytes(key)[0], mod, ((char)key) == 0xffff });
+        queue(KeyType{ conversion.to_bytes(key)[0], mod, ((char)key) == 0xffff });
     }
 }
 
 void Window::resizeEvent(Dimensions dims) {
     EventReceiver::dimensions(dims);
     m_Graphics.dimensions(dims);
-    windowsLoop();
+    const bool _pipelined = std::exchange(pipelined, false); // The last frame has the old size
+    frame();
+    pipelined = _pipelined;
+}
+
+void WindowBase::wait(std::optional<TimePoint> until) {
+    DWORD _timeout = INFINITE;
+    if (until) {
+        const auto _left = std::chrono::ceil<std::chrono::milliseconds>(*until - std::chrono::steady_clock::now());
+        _timeout = static_cast<DWORD>(std::max<std::int64_t>(_left.count(), 0));
+    }
+    MsgWaitForMultipleObjectsEx(1, &wakeEvent, _timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
+void WindowBase::wake() { SetEvent(wakeEvent); }
+
+void WindowBase::verticalBlank() {
+    DwmFlush(); // Returns once the compositor presented the next frame
 }
 
 LRESULT Window::windowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
@@ -372,4 +416,4 @@ LRESULT Window::windowSubProc(HWND hwnd, UINT msg, WPARAM wparam,
     }
 
     return DefSubclassProc(hwnd, msg, wparam, lparam);
-}
+}
\ No newline at end of file